@@ -0,0 +1,93 @@
+#ifndef ALLOC_COUNTER_HPP
+#define ALLOC_COUNTER_HPP
+
+#include <cstddef>
+#include <iostream>
+
+// Build with TRADE_MARKET_COUNT_ALLOCS to replace the global operator new with a per-thread counting version. The
+// render loop uses it to flag steady-state frames that touch the heap, and trade_market_alloc_check fails on them
+// headless; in normal builds everything here is a no-op.
+#ifdef TRADE_MARKET_COUNT_ALLOCS
+#include <cstdlib>
+#include <new>
+
+size_t& thread_alloc_counter()
+{
+	static thread_local size_t count = 0;
+	return count;
+}
+
+void* operator new(size_t size)
+{
+	++thread_alloc_counter();
+	if (void* ptr = std::malloc(size != 0 ? size : 1))
+	{
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+#endif
+
+size_t thread_alloc_count()
+{
+#ifdef TRADE_MARKET_COUNT_ALLOCS
+	return thread_alloc_counter();
+#else
+	return 0;
+#endif
+}
+
+class FrameAllocationCheck
+{
+  public:
+	explicit FrameAllocationCheck(size_t warmup_frames = 120) : m_warmup_frames(warmup_frames) {}
+
+	void begin_frame() { m_frame_start = thread_alloc_count(); }
+
+	// steady_state is false for frames that consumed input or new data, which are allowed to allocate.
+	void end_frame(bool steady_state)
+	{
+		size_t allocations = thread_alloc_count() - m_frame_start;
+		if (m_frames++ < m_warmup_frames || !steady_state || allocations == 0)
+		{
+			return;
+		}
+		++m_violations;
+		std::cerr << "Steady-state frame " << m_frames << " performed " << allocations << " heap allocations\n";
+	}
+
+	size_t violations() const { return m_violations; }
+
+  private:
+	size_t m_warmup_frames;
+	size_t m_frame_start = 0;
+	size_t m_frames		 = 0;
+	size_t m_violations	 = 0;
+};
+
+#endif // ALLOC_COUNTER_HPP
@@ -0,0 +1,62 @@
+#ifndef ASSET_REGISTRY_HPP
+#define ASSET_REGISTRY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Dense handle for an interned asset id; handles are never reused, so they can index flat per-asset arrays.
+using AssetId = uint32_t;
+
+constexpr AssetId no_asset	   = std::numeric_limits<AssetId>::max();
+constexpr size_t no_watch_slot = std::numeric_limits<size_t>::max();
+
+struct AssetState
+{
+	size_t watch_slot = no_watch_slot;
+};
+
+// Interns CoinGecko ids once; everything past the boundary (quotes, UI rows, the market board) works on AssetId and
+// indexes arrays.
+// Not thread-safe: only the thread that applies snapshots and drives the UI touches it.
+class AssetRegistry
+{
+  public:
+	AssetId intern(const std::string& id)
+	{
+		auto it = m_index.find(id);
+		if (it != m_index.end())
+		{
+			return it->second;
+		}
+
+		const AssetId asset = static_cast<AssetId>(m_names.size());
+		m_index.emplace(id, asset);
+		m_names.push_back(id);
+		m_states.emplace_back();
+		return asset;
+	}
+
+	AssetId find(const std::string& id) const
+	{
+		auto it = m_index.find(id);
+		return it == m_index.end() ? no_asset : it->second;
+	}
+
+	const std::string& name(AssetId asset) const { return m_names[asset]; }
+	const std::vector<std::string>& names() const { return m_names; }
+	AssetState& state(AssetId asset) { return m_states[asset]; }
+	const AssetState& state(AssetId asset) const { return m_states[asset]; }
+	bool watched(AssetId asset) const { return asset < m_states.size() && m_states[asset].watch_slot != no_watch_slot; }
+	size_t size() const { return m_names.size(); }
+
+  private:
+	std::unordered_map<std::string, AssetId> m_index;
+	std::vector<std::string> m_names;
+	std::vector<AssetState> m_states;
+};
+
+#endif // ASSET_REGISTRY_HPP
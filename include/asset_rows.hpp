@@ -0,0 +1,42 @@
+#ifndef ASSET_ROWS_HPP
+#define ASSET_ROWS_HPP
+
+#include "market_state.hpp"
+
+#include <string>
+#include <vector>
+
+// Watchlist view model: one row per watched asset with its ImGui labels precomputed, rebuilt only when the watchlist
+// changes so drawing the list does no string work. Kept free of ImGui so trade_market_alloc_check can run it.
+struct AssetRow
+{
+	AssetId asset = no_asset;
+	std::string id;
+	std::string focus_label;
+	std::string remove_label;
+};
+
+std::vector<AssetRow> g_asset_rows;
+
+void rebuild_asset_rows()
+{
+	for (const auto& row : g_asset_rows)
+	{
+		g_assets.state(row.asset).watch_slot = no_watch_slot;
+	}
+
+	g_asset_rows.resize(g_crypto_watchlist.size());
+	for (size_t idx_for_i = 0; idx_for_i < g_crypto_watchlist.size(); ++idx_for_i)
+	{
+		AssetRow& row	 = g_asset_rows[idx_for_i];
+		const auto& id	 = g_crypto_watchlist[idx_for_i];
+		row.asset		 = g_assets.intern(id);
+		row.id			 = id;
+		row.focus_label	 = "Focus##" + id;
+		row.remove_label = "Remove##" + id;
+
+		g_assets.state(row.asset).watch_slot = idx_for_i;
+	}
+}
+
+#endif // ASSET_ROWS_HPP
@@ -0,0 +1,128 @@
+#ifndef CANDLES_HPP
+#define CANDLES_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// One OHLC bar. CoinGecko quotes carry no traded size, so volume is the number of ticks folded into the bar.
+struct Candle
+{
+	double time;
+	double open;
+	double high;
+	double low;
+	double close;
+	double volume;
+};
+
+constexpr size_t candle_interval_count = 4;
+constexpr std::array<double, candle_interval_count> candle_intervals{60.0, 300.0, 3600.0, 86400.0};
+constexpr std::array<const char*, candle_interval_count> candle_interval_labels{"1m", "5m", "1h", "1d"};
+
+// Bars of a single interval kept in a bounded ring that grows on demand up to capacity, so an asset with little
+// history does not pay for 2048 bars per interval. The newest bar stays open and is updated in place until a tick
+// lands in a later bucket, so each append is O(1) and never rescans older bars.
+class CandleSeries
+{
+  public:
+	explicit CandleSeries(double interval = 60.0, size_t capacity = 2048) : m_interval(interval), m_capacity(capacity) {}
+
+	// Ticks older than the open bar are dropped; the store only feeds increasing timestamps.
+	bool append(double t, double price)
+	{
+		const double bucket = std::floor(t / m_interval) * m_interval;
+		if (m_size > 0)
+		{
+			Candle& open = at(m_size - 1);
+			if (bucket < open.time)
+			{
+				return false;
+			}
+			if (bucket == open.time)
+			{
+				open.high  = price > open.high ? price : open.high;
+				open.low   = price < open.low ? price : open.low;
+				open.close = price;
+				open.volume += 1.0;
+				return true;
+			}
+		}
+
+		const Candle candle = {bucket, price, price, price, price, 1.0};
+		if (m_size < m_capacity)
+		{
+			// Not wrapped yet, so the next slot is always the end of the vector.
+			m_candles.push_back(candle);
+			++m_size;
+			return true;
+		}
+
+		m_candles[m_head] = candle;
+		if (++m_head == m_capacity)
+		{
+			m_head = 0;
+		}
+		return true;
+	}
+
+	double interval() const { return m_interval; }
+	size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	const Candle& operator[](size_t index) const { return m_candles[physical(index)]; }
+	const Candle& back() const { return (*this)[m_size - 1]; }
+
+  private:
+	size_t physical(size_t index) const
+	{
+		size_t slot = m_head + index;
+		return slot >= m_candles.size() ? slot - m_candles.size() : slot;
+	}
+
+	Candle& at(size_t index) { return m_candles[physical(index)]; }
+
+	double m_interval;
+	size_t m_capacity;
+	std::vector<Candle> m_candles;
+	size_t m_head = 0;
+	size_t m_size = 0;
+};
+
+// 1m/5m/1h/1d bars for one asset, all advanced by the same tick.
+class CandleSet
+{
+  public:
+	explicit CandleSet(size_t capacity = 2048)
+	{
+		for (size_t idx_for_i = 0; idx_for_i < candle_interval_count; ++idx_for_i)
+		{
+			m_series[idx_for_i] = CandleSeries(candle_intervals[idx_for_i], capacity);
+		}
+	}
+
+	void append(double t, double price)
+	{
+		for (auto& series : m_series)
+		{
+			series.append(t, price);
+		}
+	}
+
+	template <typename Xs, typename Ys>
+	void build(const Xs& times, const Ys& prices)
+	{
+		*this = CandleSet();
+		for (size_t idx_for_i = 0; idx_for_i < times.size(); ++idx_for_i)
+		{
+			append(times[idx_for_i], prices[idx_for_i]);
+		}
+	}
+
+	const CandleSeries& interval(size_t index) const { return m_series[index]; }
+
+  private:
+	std::array<CandleSeries, candle_interval_count> m_series;
+};
+
+#endif // CANDLES_HPP
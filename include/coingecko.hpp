@@ -0,0 +1,394 @@
+#ifndef COINGECKO_HPP
+#define COINGECKO_HPP
+
+#include "json_stream.hpp"
+#include "profiler.hpp"
+#include "request_engine.hpp"
+#include "tick_clock.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct PriceQuote
+{
+	std::string id;
+	float price;
+	double exchange_time = 0.0;
+};
+
+struct PriceSnapshot
+{
+	// Receive time on g_tick_clock; quotes carrying an exchange_time are stamped with that instead.
+	double timestamp = 0.0;
+	std::vector<PriceQuote> quotes;
+};
+
+double tick_time(const PriceSnapshot& snapshot, const PriceQuote& quote) { return quote.exchange_time > 0.0 ? quote.exchange_time : snapshot.timestamp; }
+
+// SAX handler for simple/price replies: {"<id>": {"usd": <price>, "last_updated_at": <unix seconds>}, ...}. Only ids
+// that were asked for produce quotes; anything else the server sends back is ignored.
+class SimplePriceHandler
+{
+  public:
+	SimplePriceHandler(std::vector<PriceQuote>& out, std::vector<std::string> requested) : m_out(out), m_requested(std::move(requested))
+	{
+		std::sort(m_requested.begin(), m_requested.end());
+	}
+
+	void start_object()
+	{
+		if (++m_depth == 2)
+		{
+			m_has_price		= false;
+			m_exchange_time = 0.0;
+		}
+	}
+
+	void end_object()
+	{
+		if (m_depth-- == 2 && m_has_price && std::binary_search(m_requested.begin(), m_requested.end(), m_id))
+		{
+			m_out.push_back({m_id, m_price, m_exchange_time});
+		}
+	}
+
+	void start_array() { ++m_depth; }
+	void end_array() { --m_depth; }
+
+	void key(std::string_view key)
+	{
+		if (m_depth == 1)
+		{
+			m_id.assign(key.data(), key.size());
+		}
+		else if (m_depth == 2)
+		{
+			m_field = key == "usd" ? Field::usd : (key == "last_updated_at" ? Field::last_updated_at : Field::other);
+		}
+	}
+
+	void number(double value)
+	{
+		if (m_depth != 2)
+		{
+			return;
+		}
+		if (m_field == Field::usd)
+		{
+			m_price		= static_cast<float>(value);
+			m_has_price = true;
+		}
+		else if (m_field == Field::last_updated_at)
+		{
+			m_exchange_time = value;
+		}
+	}
+
+	void string(std::string_view) {}
+	void literal() {}
+
+  private:
+	enum class Field
+	{
+		other,
+		usd,
+		last_updated_at
+	};
+
+	std::vector<PriceQuote>& m_out;
+	std::vector<std::string> m_requested;
+	int m_depth	  = 0;
+	Field m_field = Field::other;
+	std::string m_id;
+	bool m_has_price	   = false;
+	float m_price		   = 0.0F;
+	double m_exchange_time = 0.0;
+};
+
+// SAX handler for market_chart replies; appends each [timestamp_ms, price] pair of the "prices" array as it is
+// parsed and skips market_caps/total_volumes.
+class MarketChartHandler
+{
+  public:
+	MarketChartHandler(std::vector<double>& out_times, std::vector<double>& out_prices) : m_times(out_times), m_prices(out_prices) {}
+
+	void start_object() { ++m_depth; }
+	void end_object() { --m_depth; }
+
+	void start_array()
+	{
+		++m_depth;
+		if (m_depth == 2 && m_prices_key)
+		{
+			m_in_prices	 = true;
+			m_saw_prices = true;
+		}
+		else if (m_in_prices && m_depth == 3)
+		{
+			m_field = 0;
+		}
+	}
+
+	void end_array()
+	{
+		if (m_in_prices && m_depth == 3 && m_field == 2)
+		{
+			m_times.push_back(m_timestamp / 1000.0);
+			m_prices.push_back(m_price);
+		}
+		else if (m_depth == 2)
+		{
+			m_in_prices = false;
+		}
+		--m_depth;
+	}
+
+	void key(std::string_view key)
+	{
+		if (m_depth == 1)
+		{
+			m_prices_key = key == "prices";
+		}
+	}
+
+	void number(double value)
+	{
+		if (!m_in_prices || m_depth != 3)
+		{
+			return;
+		}
+		if (m_field == 0)
+		{
+			m_timestamp = value;
+		}
+		else if (m_field == 1)
+		{
+			m_price = value;
+		}
+		++m_field;
+	}
+
+	void string(std::string_view) {}
+
+	// A null price invalidates the pair.
+	void literal()
+	{
+		if (m_in_prices && m_depth == 3)
+		{
+			m_field = 3;
+		}
+	}
+
+	bool saw_prices() const { return m_saw_prices; }
+
+  private:
+	std::vector<double>& m_times;
+	std::vector<double>& m_prices;
+	int m_depth		   = 0;
+	bool m_prices_key  = false;
+	bool m_in_prices   = false;
+	bool m_saw_prices  = false;
+	int m_field		   = 0;
+	double m_timestamp = 0.0;
+	double m_price	   = 0.0;
+};
+
+using SimplePriceStream = JsonStream<SimplePriceHandler>;
+using MarketChartStream = JsonStream<MarketChartHandler>;
+
+std::string default_coingecko_base_url()
+{
+	const char* env = std::getenv("COINGECKO_BASE_URL");
+	return env && *env ? env : "https://api.coingecko.com/api/v3";
+}
+
+// COINGECKO_BASE_URL points the client at a stand-in such as trade_market_mock instead of the live API.
+std::string g_coingecko_base_url = default_coingecko_base_url();
+
+constexpr std::string_view price_url_path	= "/simple/price?ids=";
+constexpr std::string_view price_url_suffix = "&vs_currencies=usd&include_last_updated_at=true";
+
+// Conservative bound on a simple/price URL; proxies and CDNs commonly reject request lines past 2-8 KiB.
+constexpr size_t price_url_limit = 2000;
+
+// Splits the watchlist into batches whose simple/price URL stays within max_url bytes. An id too long to fit even on
+// its own still gets a batch, so nothing is dropped.
+std::vector<std::vector<std::string>> shard_watchlist(const std::vector<std::string>& watchlist, size_t max_url = price_url_limit)
+{
+	const size_t fixed = g_coingecko_base_url.size() + price_url_path.size() + price_url_suffix.size();
+	std::vector<std::vector<std::string>> batches;
+	size_t length = 0;
+	for (const auto& id : watchlist)
+	{
+		if (batches.empty() || fixed + length + 1 + id.size() > max_url)
+		{
+			batches.emplace_back();
+			length = 0;
+		}
+		length += (batches.back().empty() ? 0 : 1) + id.size();
+		batches.back().push_back(id);
+	}
+	return batches;
+}
+
+HttpRequest make_price_request(const std::vector<std::string>& watchlist, const std::string& api_key)
+{
+	std::string ids;
+	for (const auto& id : watchlist)
+	{
+		if (!ids.empty())
+		{
+			ids += ",";
+		}
+		ids += id;
+	}
+
+	HttpRequest request;
+	request.url		   = g_coingecko_base_url + std::string(price_url_path) + ids + std::string(price_url_suffix);
+	request.headers	   = {"x-cg-demo-api-key: " + api_key};
+	request.timeout_ms = 5000;
+	return request;
+}
+
+bool finish_price_response(const HttpResponse& response, SimplePriceStream& stream)
+{
+	g_profiler.record(ProfileZone::parse, stream.parse_seconds);
+	if (response.result != CURLE_OK)
+	{
+		std::cerr << "CURL error: " << curl_easy_strerror(response.result) << "\n";
+		return false;
+	}
+	if (!response.ok())
+	{
+		std::cerr << "simple/price returned HTTP " << response.status << "\n";
+		return false;
+	}
+	if (!stream.tokenizer.finish())
+	{
+		std::cerr << "JSON parsing error in simple/price response (HTTP " << response.status << ")\n";
+		return false;
+	}
+	return true;
+}
+
+HttpRequest make_history_request(const std::string& id, int days)
+{
+	HttpRequest request;
+	request.url		   = g_coingecko_base_url + "/coins/" + id + "/market_chart?vs_currency=usd&days=" + std::to_string(days);
+	request.timeout_ms = 10000;
+	return request;
+}
+
+bool finish_history_response(const HttpResponse& response, MarketChartStream& stream)
+{
+	g_profiler.record(ProfileZone::parse, stream.parse_seconds);
+	if (response.result != CURLE_OK)
+	{
+		std::cerr << "CURL error: " << curl_easy_strerror(response.result) << "\n";
+		return false;
+	}
+	return response.ok() && stream.tokenizer.finish() && stream.handler.saw_prices();
+}
+
+// What a poll saw on the wire, for the scheduler to adapt to.
+struct FetchReport
+{
+	size_t requests		 = 0;
+	size_t failed		 = 0;
+	size_t throttled	 = 0;
+	double retry_after	 = 0.0;
+	double slowest_reply = 0.0;
+};
+
+// Seconds form of Retry-After; the HTTP-date form is not worth parsing here and reads as "unspecified".
+double parse_retry_after(const HttpResponse& response)
+{
+	const std::string* value = response.header("retry-after");
+	if (!value || value->empty() || !std::isdigit(static_cast<unsigned char>((*value)[0])))
+	{
+		return 0.0;
+	}
+	return std::strtod(value->c_str(), nullptr);
+}
+
+// Issues one simple/price request per URL-sized batch, all in flight at once, and merges the quotes. A failed batch
+// only loses its own ids; the call succeeds if any batch did.
+bool fetch_watchlist_prices(const std::vector<std::string>& watchlist, const std::string& api_key, PriceSnapshot& out, FetchReport* report = nullptr,
+							RequestEngine& engine = g_request_engine)
+{
+	out.quotes.clear();
+	if (watchlist.empty())
+	{
+		return false;
+	}
+	ProfileScope fetch_scope(ProfileZone::fetch);
+
+	struct Batch
+	{
+		std::vector<PriceQuote> quotes;
+		std::shared_ptr<SimplePriceStream> stream;
+		std::future<HttpResponse> response;
+	};
+
+	// Each stream writes into its batch's quotes, so the vector must not reallocate once streams exist.
+	const auto shards = shard_watchlist(watchlist);
+	std::vector<Batch> batches;
+	batches.reserve(shards.size());
+	for (const auto& ids : shards)
+	{
+		batches.emplace_back();
+		Batch& batch		= batches.back();
+		batch.stream		= std::make_shared<SimplePriceStream>(batch.quotes, ids);
+		HttpRequest request = make_price_request(ids, api_key);
+		request.on_data		= [stream = batch.stream](const char* data, size_t size) { return stream->feed(data, size); };
+		batch.response		= engine.submit(std::move(request));
+	}
+
+	bool any_ok = false;
+	for (auto& batch : batches)
+	{
+		HttpResponse response = batch.response.get();
+		if (report)
+		{
+			++report->requests;
+			report->slowest_reply = std::max(report->slowest_reply, response.elapsed);
+			if (response.status == 429)
+			{
+				++report->throttled;
+				report->retry_after = std::max(report->retry_after, parse_retry_after(response));
+			}
+		}
+		if (!finish_price_response(response, *batch.stream))
+		{
+			if (report)
+			{
+				++report->failed;
+			}
+			continue;
+		}
+		any_ok = true;
+		out.quotes.insert(out.quotes.end(), std::make_move_iterator(batch.quotes.begin()), std::make_move_iterator(batch.quotes.end()));
+	}
+	out.timestamp = g_tick_clock.now();
+	return any_ok;
+}
+
+bool fetch_crypto_history(const std::string& id, int days, std::vector<double>& out_times, std::vector<double>& out_prices, RequestEngine& engine = g_request_engine)
+{
+	auto stream			= std::make_shared<MarketChartStream>(out_times, out_prices);
+	HttpRequest request = make_history_request(id, days);
+	request.on_data		= [stream](const char* data, size_t size) { return stream->feed(data, size); };
+
+	HttpResponse response = engine.submit(std::move(request)).get();
+	return finish_history_response(response, *stream);
+}
+
+#endif // COINGECKO_HPP
@@ -0,0 +1,154 @@
+#ifndef CURL_POOL_HPP
+#define CURL_POOL_HPP
+
+#include <array>
+#include <curl/curl.h>
+#include <mutex>
+#include <vector>
+
+// Keeps easy handles alive between requests so their connection caches stay warm, and shares the DNS and TLS session
+// caches between all of them. Connection sharing through CURLSH is left out on purpose: libcurl does not support it
+// across concurrently running threads.
+class CurlPool
+{
+  public:
+	explicit CurlPool(size_t max_idle = 8) : m_max_idle(max_idle) {}
+	CurlPool(const CurlPool&)			 = delete;
+	CurlPool& operator=(const CurlPool&) = delete;
+	~CurlPool() { shutdown(); }
+
+	CURL* acquire()
+	{
+		CURL* curl	  = nullptr;
+		CURLSH* share = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_share && !m_shutdown)
+			{
+				create_share();
+			}
+			share = m_share;
+			if (!m_idle.empty())
+			{
+				curl = m_idle.back();
+				m_idle.pop_back();
+			}
+		}
+
+		if (!curl)
+		{
+			curl = curl_easy_init();
+			if (!curl)
+			{
+				return nullptr;
+			}
+		}
+
+		apply_defaults(curl, share);
+		return curl;
+	}
+
+	void release(CURL* curl)
+	{
+		if (!curl)
+		{
+			return;
+		}
+
+		// curl_easy_reset keeps the live connections and the shared caches, only options are cleared.
+		curl_easy_reset(curl);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_shutdown || m_idle.size() >= m_max_idle)
+		{
+			curl_easy_cleanup(curl);
+			return;
+		}
+		m_idle.push_back(curl);
+	}
+
+	// Must run before curl_global_cleanup().
+	void shutdown()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+		for (CURL* curl : m_idle)
+		{
+			curl_easy_cleanup(curl);
+		}
+		m_idle.clear();
+		if (m_share)
+		{
+			curl_share_cleanup(m_share);
+			m_share = nullptr;
+		}
+	}
+
+  private:
+	void create_share()
+	{
+		m_share = curl_share_init();
+		if (!m_share)
+		{
+			return;
+		}
+		curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, lock_share);
+		curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, unlock_share);
+		curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+		curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	}
+
+	// Takes the share as read under m_mutex, so a concurrent shutdown() cannot swap it out from under the setopt.
+	static void apply_defaults(CURL* curl, CURLSH* share)
+	{
+		if (share)
+		{
+			curl_easy_setopt(curl, CURLOPT_SHARE, share);
+		}
+		curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+		curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+		curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+		curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, 60L);
+		curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, 30L);
+		curl_easy_setopt(curl, CURLOPT_DNS_CACHE_TIMEOUT, 300L);
+		curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+	}
+
+	static void lock_share(CURL*, curl_lock_data data, curl_lock_access, void* userptr)
+	{
+		static_cast<CurlPool*>(userptr)->m_share_locks[data % CURL_LOCK_DATA_LAST].lock();
+	}
+
+	static void unlock_share(CURL*, curl_lock_data data, void* userptr)
+	{
+		static_cast<CurlPool*>(userptr)->m_share_locks[data % CURL_LOCK_DATA_LAST].unlock();
+	}
+
+	size_t m_max_idle;
+	std::mutex m_mutex;
+	std::vector<CURL*> m_idle;
+	CURLSH* m_share = nullptr;
+	bool m_shutdown = false;
+	std::array<std::mutex, CURL_LOCK_DATA_LAST> m_share_locks;
+};
+
+CurlPool g_curl_pool;
+
+class PooledCurl
+{
+  public:
+	explicit PooledCurl(CurlPool& pool = g_curl_pool) : m_pool(pool), m_curl(pool.acquire()) {}
+	PooledCurl(const PooledCurl&)			 = delete;
+	PooledCurl& operator=(const PooledCurl&) = delete;
+	~PooledCurl() { m_pool.release(m_curl); }
+
+	CURL* get() const { return m_curl; }
+	explicit operator bool() const { return m_curl != nullptr; }
+
+  private:
+	CurlPool& m_pool;
+	CURL* m_curl;
+};
+
+#endif // CURL_POOL_HPP
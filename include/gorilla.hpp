@@ -0,0 +1,547 @@
+#ifndef GORILLA_HPP
+#define GORILLA_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Gorilla-style block compression for (timestamp, price) ticks: timestamps as delta-of-delta of integer
+// milliseconds, prices as XOR against the previous float. Measured per point: about 2 bytes for 5 s local-clock ticks,
+// about 4 bytes for whole-second exchange stamps 40-80 s apart with moving cent prices (1.5 of them for the stamp),
+// and about 6 bytes when those stamps carry milliseconds.
+struct GorillaBlock
+{
+	int64_t first_ms   = 0;
+	int64_t last_ms	   = 0;
+	uint32_t count	   = 0;
+	uint64_t bit_count = 0;
+	std::vector<uint64_t> words;
+
+	size_t memory_bytes() const { return sizeof(GorillaBlock) + words.capacity() * sizeof(uint64_t); }
+};
+
+class BitWriter
+{
+  public:
+	explicit BitWriter(GorillaBlock& block) : m_block(block) {}
+
+	// Writes the low `bits` bits of value, most significant first.
+	void write(uint64_t value, unsigned bits)
+	{
+		while (bits > 0)
+		{
+			const unsigned used = static_cast<unsigned>(m_block.bit_count % 64);
+			if (used == 0)
+			{
+				m_block.words.push_back(0);
+			}
+			const unsigned room = 64 - used;
+			const unsigned take = bits < room ? bits : room;
+			const uint64_t part = (value >> (bits - take)) & mask(take);
+			m_block.words.back() |= part << (room - take);
+			m_block.bit_count += take;
+			bits -= take;
+		}
+	}
+
+	static uint64_t mask(unsigned bits) { return bits >= 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1; }
+
+  private:
+	GorillaBlock& m_block;
+};
+
+class BitReader
+{
+  public:
+	BitReader(const uint64_t* words, uint64_t bit_count) : m_words(words), m_bit_count(bit_count) {}
+
+	bool read(unsigned bits, uint64_t& out)
+	{
+		if (m_position + bits > m_bit_count)
+		{
+			return false;
+		}
+		out = 0;
+		while (bits > 0)
+		{
+			const unsigned used = static_cast<unsigned>(m_position % 64);
+			const unsigned room = 64 - used;
+			const unsigned take = bits < room ? bits : room;
+			const uint64_t part = (m_words[m_position / 64] >> (room - take)) & BitWriter::mask(take);
+			out					= (take == 64 ? 0 : out << take) | part;
+			m_position += take;
+			bits -= take;
+		}
+		return true;
+	}
+
+  private:
+	const uint64_t* m_words;
+	uint64_t m_bit_count;
+	uint64_t m_position = 0;
+};
+
+uint32_t float_bits(float value)
+{
+	uint32_t bits = 0;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+float bits_float(uint32_t bits)
+{
+	float value = 0.0F;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+int64_t to_millis(double timestamp)
+{
+	return static_cast<int64_t>(std::llround(timestamp * 1000.0));
+}
+
+// Encoder state for the block currently being written; reset it whenever a new block starts.
+class GorillaEncoder
+{
+  public:
+	void append(GorillaBlock& block, int64_t timestamp_ms, float price)
+	{
+		BitWriter writer(block);
+		const uint32_t bits = float_bits(price);
+		if (block.count == 0)
+		{
+			writer.write(static_cast<uint64_t>(timestamp_ms), 64);
+			writer.write(bits, 32);
+			block.first_ms = timestamp_ms;
+		}
+		else
+		{
+			const int64_t delta = timestamp_ms - block.last_ms;
+			write_delta_of_delta(writer, delta - m_prev_delta);
+			m_prev_delta = delta;
+			write_value(writer, bits);
+		}
+		block.last_ms = timestamp_ms;
+		m_prev_bits	  = bits;
+		++block.count;
+	}
+
+  private:
+	// Besides the millisecond buckets there is one for whole seconds, so second-granular exchange stamps a minute or so
+	// apart do not fall through to the 32-bit bucket.
+	static void write_delta_of_delta(BitWriter& writer, int64_t dod)
+	{
+		if (dod == 0)
+		{
+			writer.write(0b0, 1);
+		}
+		else if (dod >= -63 && dod <= 64)
+		{
+			writer.write(0b10, 2);
+			writer.write(static_cast<uint64_t>(dod + 63), 7);
+		}
+		else if (dod >= -255 && dod <= 256)
+		{
+			writer.write(0b110, 3);
+			writer.write(static_cast<uint64_t>(dod + 255), 9);
+		}
+		else if (dod % 1000 == 0 && dod >= -127000 && dod <= 128000)
+		{
+			writer.write(0b1110, 4);
+			writer.write(static_cast<uint64_t>(dod / 1000 + 127), 8);
+		}
+		else if (dod >= -2047 && dod <= 2048)
+		{
+			writer.write(0b11110, 5);
+			writer.write(static_cast<uint64_t>(dod + 2047), 12);
+		}
+		else if (dod >= -524287 && dod <= 524288)
+		{
+			writer.write(0b111110, 6);
+			writer.write(static_cast<uint64_t>(dod + 524287), 20);
+		}
+		else if (dod >= INT32_MIN && dod <= INT32_MAX)
+		{
+			writer.write(0b1111110, 7);
+			writer.write(static_cast<uint32_t>(static_cast<int32_t>(dod)), 32);
+		}
+		else
+		{
+			writer.write(0b1111111, 7);
+			writer.write(static_cast<uint64_t>(dod), 64);
+		}
+	}
+
+	void write_value(BitWriter& writer, uint32_t bits)
+	{
+		const uint32_t diff = bits ^ m_prev_bits;
+		if (diff == 0)
+		{
+			writer.write(0b0, 1);
+			return;
+		}
+
+		unsigned leading  = static_cast<unsigned>(__builtin_clz(diff));
+		unsigned trailing = static_cast<unsigned>(__builtin_ctz(diff));
+		if (leading > 31)
+		{
+			leading = 31;
+		}
+
+		if (m_prev_leading <= leading && m_prev_trailing <= trailing)
+		{
+			writer.write(0b10, 2);
+			writer.write(diff >> m_prev_trailing, 32 - m_prev_leading - m_prev_trailing);
+			return;
+		}
+
+		const unsigned length = 32 - leading - trailing;
+		writer.write(0b11, 2);
+		writer.write(leading, 5);
+		writer.write(length - 1, 5);
+		writer.write(diff >> trailing, length);
+		m_prev_leading	= leading;
+		m_prev_trailing = trailing;
+	}
+
+	int64_t m_prev_delta	 = 0;
+	uint32_t m_prev_bits	 = 0;
+	unsigned m_prev_leading	 = 32;
+	unsigned m_prev_trailing = 32;
+};
+
+class GorillaDecoder
+{
+  public:
+	explicit GorillaDecoder(const GorillaBlock& block) : m_reader(block.words.data(), block.bit_count), m_remaining(block.count) {}
+
+	bool next(int64_t& timestamp_ms, float& price)
+	{
+		if (m_remaining == 0)
+		{
+			return false;
+		}
+
+		uint64_t raw = 0;
+		if (m_first)
+		{
+			uint64_t bits = 0;
+			if (!m_reader.read(64, raw) || !m_reader.read(32, bits))
+			{
+				return false;
+			}
+			m_timestamp = static_cast<int64_t>(raw);
+			m_bits		= static_cast<uint32_t>(bits);
+			m_first		= false;
+		}
+		else
+		{
+			int64_t dod = 0;
+			if (!read_delta_of_delta(dod) || !read_value())
+			{
+				return false;
+			}
+			m_delta += dod;
+			m_timestamp += m_delta;
+		}
+
+		--m_remaining;
+		timestamp_ms = m_timestamp;
+		price		 = bits_float(m_bits);
+		return true;
+	}
+
+  private:
+	bool read_delta_of_delta(int64_t& dod)
+	{
+		static constexpr unsigned widths[] = {7, 9, 8, 12, 20, 32, 64};
+		static constexpr int64_t biases[]  = {63, 255, 127, 2047, 524287, 0, 0};
+		static constexpr int64_t scales[]  = {1, 1, 1000, 1, 1, 1, 1};
+		unsigned prefix					   = 0;
+		uint64_t bit					   = 0;
+		while (prefix < 7)
+		{
+			if (!m_reader.read(1, bit))
+			{
+				return false;
+			}
+			if (bit == 0)
+			{
+				break;
+			}
+			++prefix;
+		}
+
+		if (prefix == 0)
+		{
+			dod = 0;
+			return true;
+		}
+
+		uint64_t raw		  = 0;
+		const unsigned bucket = prefix - 1;
+		if (!m_reader.read(widths[bucket], raw))
+		{
+			return false;
+		}
+		if (widths[bucket] == 32)
+		{
+			dod = static_cast<int32_t>(static_cast<uint32_t>(raw));
+		}
+		else if (widths[bucket] == 64)
+		{
+			dod = static_cast<int64_t>(raw);
+		}
+		else
+		{
+			dod = (static_cast<int64_t>(raw) - biases[bucket]) * scales[bucket];
+		}
+		return true;
+	}
+
+	bool read_value()
+	{
+		uint64_t control = 0;
+		if (!m_reader.read(1, control))
+		{
+			return false;
+		}
+		if (control == 0)
+		{
+			return true;
+		}
+		if (!m_reader.read(1, control))
+		{
+			return false;
+		}
+		if (control == 1)
+		{
+			uint64_t leading = 0;
+			uint64_t length	 = 0;
+			if (!m_reader.read(5, leading) || !m_reader.read(5, length))
+			{
+				return false;
+			}
+			m_leading  = static_cast<unsigned>(leading);
+			m_trailing = 32 - m_leading - static_cast<unsigned>(length + 1);
+		}
+
+		uint64_t meaningful = 0;
+		if (!m_reader.read(32 - m_leading - m_trailing, meaningful))
+		{
+			return false;
+		}
+		m_bits ^= static_cast<uint32_t>(meaningful << m_trailing);
+		return true;
+	}
+
+	BitReader m_reader;
+	uint32_t m_remaining;
+	bool m_first		= true;
+	int64_t m_timestamp = 0;
+	int64_t m_delta		= 0;
+	uint32_t m_bits		= 0;
+	unsigned m_leading	= 0;
+	unsigned m_trailing = 0;
+};
+
+// Append-only compressed history: sealed blocks of block_points ticks plus one open block that is still growing.
+// Sealed blocks older than the retention window are dropped.
+// How far back the archive and the on-disk .blocks files reach, measured from the newest sealed block.
+constexpr double archive_retention_seconds = 90.0 * 24 * 3600;
+
+class CompressedSeries
+{
+  public:
+	explicit CompressedSeries(uint32_t block_points = 4096, double retention_seconds = archive_retention_seconds)
+		: m_block_points(block_points), m_retention_ms(to_millis(retention_seconds))
+	{
+	}
+
+	// Returns true when the append sealed a block.
+	bool append(double timestamp, float price)
+	{
+		const int64_t timestamp_ms = to_millis(timestamp);
+		// last_ms() is INT64_MIN while empty; size() would walk every sealed block on each tick.
+		if (timestamp_ms <= last_ms())
+		{
+			return false;
+		}
+
+		m_encoder.append(m_open, timestamp_ms, price);
+		if (m_open.count < m_block_points)
+		{
+			return false;
+		}
+
+		// A sealed block never grows again; drop the vector's growth slack.
+		m_open.words.shrink_to_fit();
+		m_sealed.push_back(std::move(m_open));
+		m_open	  = GorillaBlock();
+		m_encoder = GorillaEncoder();
+		trim(m_sealed.back().last_ms - m_retention_ms);
+		return true;
+	}
+
+	// Adopts a block loaded from disk. Blocks must arrive in time order and before any append(); older ones falling out
+	// of the retention window are dropped.
+	void add_sealed(GorillaBlock block)
+	{
+		m_sealed.push_back(std::move(block));
+		trim(m_sealed.back().last_ms - m_retention_ms);
+	}
+
+	int64_t retention_ms() const { return m_retention_ms; }
+
+	const std::vector<GorillaBlock>& sealed() const { return m_sealed; }
+	const GorillaBlock& open_block() const { return m_open; }
+
+	size_t size() const
+	{
+		size_t total = m_open.count;
+		for (const auto& block : m_sealed)
+		{
+			total += block.count;
+		}
+		return total;
+	}
+
+	int64_t last_ms() const { return m_open.count > 0 ? m_open.last_ms : (m_sealed.empty() ? INT64_MIN : m_sealed.back().last_ms); }
+
+	size_t memory_bytes() const
+	{
+		size_t total = m_open.memory_bytes();
+		for (const auto& block : m_sealed)
+		{
+			total += block.memory_bytes();
+		}
+		return total;
+	}
+
+	int64_t first_ms() const { return m_sealed.empty() ? (m_open.count > 0 ? m_open.first_ms : INT64_MIN) : m_sealed.front().first_ms; }
+
+	// Calls fn(timestamp_seconds, price) for every tick at or after since, oldest first. Whole blocks that end
+	// before since are skipped without decoding.
+	template <typename Fn>
+	void for_each_since(double since, Fn&& fn) const
+	{
+		visit_range(to_millis(since), INT64_MAX, fn);
+	}
+
+	// Same for ticks in [since, until): blocks starting at or after until are not decoded either, and decoding stops
+	// at the first tick past the range.
+	template <typename Fn>
+	void for_each_between(double since, double until, Fn&& fn) const
+	{
+		visit_range(to_millis(since), to_millis(until), fn);
+	}
+
+  private:
+	template <typename Fn>
+	void visit_range(int64_t since_ms, int64_t until_ms, Fn& fn) const
+	{
+		auto visit = [&](const GorillaBlock& block)
+		{
+			if (block.count == 0 || block.last_ms < since_ms || block.first_ms >= until_ms)
+			{
+				return block.count == 0 || block.first_ms < until_ms;
+			}
+			GorillaDecoder decoder(block);
+			int64_t timestamp_ms = 0;
+			float price			 = 0.0F;
+			while (decoder.next(timestamp_ms, price) && timestamp_ms < until_ms)
+			{
+				if (timestamp_ms >= since_ms)
+				{
+					fn(static_cast<double>(timestamp_ms) / 1000.0, price);
+				}
+			}
+			return timestamp_ms < until_ms;
+		};
+
+		for (const auto& block : m_sealed)
+		{
+			if (!visit(block))
+			{
+				return;
+			}
+		}
+		visit(m_open);
+	}
+
+	void trim(int64_t cutoff_ms)
+	{
+		size_t expired = 0;
+		while (expired < m_sealed.size() && m_sealed[expired].last_ms < cutoff_ms)
+		{
+			++expired;
+		}
+		if (expired > 0)
+		{
+			m_sealed.erase(m_sealed.begin(), m_sealed.begin() + static_cast<std::ptrdiff_t>(expired));
+		}
+	}
+
+	uint32_t m_block_points;
+	int64_t m_retention_ms;
+	std::vector<GorillaBlock> m_sealed;
+	GorillaBlock m_open;
+	GorillaEncoder m_encoder;
+};
+
+// On-disk block framing used by the .blocks files next to the tick journals.
+struct GorillaBlockHeader
+{
+	uint32_t count;
+	uint32_t word_count;
+	int64_t first_ms;
+	int64_t last_ms;
+	uint64_t bit_count;
+};
+
+static_assert(sizeof(GorillaBlockHeader) == 32, "gorilla block header layout");
+
+bool write_gorilla_block(FILE* file, const GorillaBlock& block)
+{
+	GorillaBlockHeader header{block.count, static_cast<uint32_t>(block.words.size()), block.first_ms, block.last_ms, block.bit_count};
+	return std::fwrite(&header, sizeof(header), 1, file) == 1 && std::fwrite(block.words.data(), sizeof(uint64_t), block.words.size(), file) == block.words.size();
+}
+
+// Validates the frame at cursor without copying its payload; returns false on a truncated or corrupt frame.
+bool peek_gorilla_block(const char* cursor, const char* end, GorillaBlockHeader& header)
+{
+	if (static_cast<size_t>(end - cursor) < sizeof(header))
+	{
+		return false;
+	}
+	std::memcpy(&header, cursor, sizeof(header));
+
+	const size_t payload = static_cast<size_t>(header.word_count) * sizeof(uint64_t);
+	return static_cast<size_t>(end - cursor) - sizeof(header) >= payload && header.bit_count <= static_cast<uint64_t>(header.word_count) * 64;
+}
+
+size_t gorilla_frame_size(const GorillaBlockHeader& header) { return sizeof(GorillaBlockHeader) + static_cast<size_t>(header.word_count) * sizeof(uint64_t); }
+
+// Reads one framed block from [cursor, end) and advances cursor; returns false on a truncated or corrupt frame.
+bool read_gorilla_block(const char*& cursor, const char* end, GorillaBlock& block)
+{
+	GorillaBlockHeader header{};
+	if (!peek_gorilla_block(cursor, end, header))
+	{
+		return false;
+	}
+
+	const size_t payload = static_cast<size_t>(header.word_count) * sizeof(uint64_t);
+	block.count		= header.count;
+	block.first_ms	= header.first_ms;
+	block.last_ms	= header.last_ms;
+	block.bit_count = header.bit_count;
+	block.words.resize(header.word_count);
+	std::memcpy(block.words.data(), cursor + sizeof(header), payload);
+	cursor += sizeof(header) + payload;
+	return true;
+}
+
+#endif // GORILLA_HPP
@@ -0,0 +1,209 @@
+#ifndef HISTORY_SERVICE_HPP
+#define HISTORY_SERVICE_HPP
+
+#include "candles.hpp"
+#include "coingecko.hpp"
+#include "lod.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct HistorySeries
+{
+	bool ok = false;
+	std::vector<double> times;
+	std::vector<double> prices;
+	LodPyramid lod;
+	CandleSet candles;
+};
+
+using HistoryHandle = std::shared_future<std::shared_ptr<const HistorySeries>>;
+
+bool history_ready(const HistoryHandle& handle)
+{
+	return handle.valid() && handle.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+// Loads market_chart history through the request engine without blocking the caller. Successful results stay in an
+// LRU cache keyed by (id, days), and concurrent requests for the same key share one download. Once paced, downloads
+// wait in a queue until the poll loop spends a budget token on each (see submit_next), so history shares the quota
+// with price polls instead of bursting past it.
+class HistoryService
+{
+  public:
+	explicit HistoryService(size_t capacity = 32, RequestEngine& engine = g_request_engine) : m_capacity(capacity), m_engine(engine) {}
+	HistoryService(const HistoryService&)			 = delete;
+	HistoryService& operator=(const HistoryService&) = delete;
+
+	// urgent requests (the focused asset) queue ahead of prefetches, including one already queued for the same key.
+	HistoryHandle request(const std::string& id, int days, bool urgent = true)
+	{
+		Key key{id, days};
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		auto cached = m_index.find(key);
+		if (cached != m_index.end())
+		{
+			m_lru.splice(m_lru.begin(), m_lru, cached->second);
+			std::promise<std::shared_ptr<const HistorySeries>> ready;
+			ready.set_value(cached->second->second);
+			return ready.get_future().share();
+		}
+
+		auto pending = m_pending.find(key);
+		if (pending != m_pending.end())
+		{
+			auto queued = std::find(m_queue.begin(), m_queue.end(), key);
+			if (urgent && queued != m_queue.end())
+			{
+				m_queue.erase(queued);
+				m_queue.push_front(key);
+			}
+			return pending->second.handle;
+		}
+
+		Pending& job		 = m_pending[key];
+		job.handle			 = job.promise.get_future().share();
+		HistoryHandle handle = job.handle;
+
+		auto series			= std::make_shared<HistorySeries>();
+		auto stream			= std::make_shared<MarketChartStream>(series->times, series->prices);
+		HttpRequest request = make_history_request(id, days);
+		request.on_data		= [stream](const char* data, size_t size) { return stream->feed(data, size); };
+		auto submit			= [this, key, series, stream, request = std::move(request)]() mutable
+		{
+			m_engine.submit(std::move(request), [this, key, series, stream](HttpResponse&& response)
+							{
+								series->ok = finish_history_response(response, *stream);
+								if (series->ok)
+								{
+									ProfileScope history_scope(ProfileZone::history);
+									series->lod.build(series->times, series->prices);
+									series->candles.build(series->times, series->prices);
+								}
+								complete(key, series);
+							});
+		};
+
+		if (!m_on_queued)
+		{
+			lock.unlock();
+			submit();
+			return handle;
+		}
+		job.submit = std::move(submit);
+		if (urgent)
+		{
+			m_queue.push_front(key);
+		}
+		else
+		{
+			m_queue.push_back(key);
+		}
+		lock.unlock();
+		m_on_queued();
+		return handle;
+	}
+
+	// Invoked on the engine thread whenever a request completes. Set before issuing requests.
+	void set_on_ready(std::function<void()> on_ready) { m_on_ready = std::move(on_ready); }
+
+	// Paces downloads: requests are queued and on_queued is invoked, and the pacer calls submit_next() once per budget
+	// token. Set before issuing requests; without it every download is submitted at once.
+	void set_on_queued(std::function<void()> on_queued) { m_on_queued = std::move(on_queued); }
+
+	size_t queued() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_queue.size();
+	}
+
+	// Hands the front of the queue to the engine; returns false when nothing is queued.
+	bool submit_next()
+	{
+		std::function<void()> submit;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_queue.empty())
+			{
+				return false;
+			}
+			submit = std::move(m_pending[m_queue.front()].submit);
+			m_queue.pop_front();
+		}
+		submit();
+		return true;
+	}
+
+	// Warms the cache for a whole watchlist, behind any urgent request.
+	void prefetch(const std::vector<std::string>& ids, int days)
+	{
+		for (const auto& id : ids)
+		{
+			request(id, days, false);
+		}
+	}
+
+  private:
+	using Key	= std::pair<std::string, int>;
+	using Entry = std::pair<Key, std::shared_ptr<const HistorySeries>>;
+
+	struct Pending
+	{
+		std::promise<std::shared_ptr<const HistorySeries>> promise;
+		HistoryHandle handle;
+		std::function<void()> submit;
+	};
+
+	void complete(const Key& key, std::shared_ptr<HistorySeries> series)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (series->ok)
+			{
+				insert(key, series);
+			}
+			auto pending = m_pending.find(key);
+			pending->second.promise.set_value(std::move(series));
+			m_pending.erase(pending);
+		}
+
+		if (m_on_ready)
+		{
+			m_on_ready();
+		}
+	}
+
+	void insert(const Key& key, std::shared_ptr<const HistorySeries> series)
+	{
+		m_lru.emplace_front(key, std::move(series));
+		m_index[key] = m_lru.begin();
+		while (m_lru.size() > m_capacity)
+		{
+			m_index.erase(m_lru.back().first);
+			m_lru.pop_back();
+		}
+	}
+
+	size_t m_capacity;
+	RequestEngine& m_engine;
+	std::function<void()> m_on_ready;
+	std::function<void()> m_on_queued;
+	mutable std::mutex m_mutex;
+
+	std::map<Key, Pending> m_pending;
+	std::deque<Key> m_queue;
+	std::list<Entry> m_lru;
+	std::map<Key, std::list<Entry>::iterator> m_index;
+};
+
+#endif // HISTORY_SERVICE_HPP
@@ -0,0 +1,288 @@
+#ifndef INDICATORS_HPP
+#define INDICATORS_HPP
+
+#include "asset_registry.hpp"
+#include "candles.hpp"
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Candle interval the indicators run on (1h): the market_chart history they are seeded from is hourly, and live ticks
+// are resampled to the same bars so RSI and MACD periods keep meaning hours.
+constexpr size_t indicator_interval = 2;
+
+float compute_rsi(const std::vector<double>& prices, size_t period = 14)
+{
+	if (prices.size() < period + 1)
+	{
+		return 0.0;
+	}
+	double gain = 0.0, loss = 0.0;
+	for (size_t idx_for_i = prices.size() - period; idx_for_i < prices.size(); ++idx_for_i)
+	{
+		double delta = prices[idx_for_i] - prices[idx_for_i - 1];
+		if (delta >= 0)
+		{
+			gain += delta;
+		}
+		else
+		{
+			loss -= delta;
+		}
+	}
+	if (gain + loss == 0.0)
+	{
+		return 50.0;
+	}
+	double rs = gain / loss;
+	return 100.0 - (100.0 / (1.0 + rs));
+}
+
+struct IndicatorSnapshot
+{
+	size_t samples = 0;
+	double rsi	   = 0.0;
+	double macd	   = 0.0;
+	double signal  = 0.0;
+	double hist	   = 0.0;
+};
+
+struct MacdSeries
+{
+	std::vector<double> macd;
+	std::vector<double> signal;
+	std::vector<double> histogram;
+
+	void clear()
+	{
+		macd.clear();
+		signal.clear();
+		histogram.clear();
+	}
+
+	void push_back(const IndicatorSnapshot& snapshot)
+	{
+		macd.push_back(snapshot.macd);
+		signal.push_back(snapshot.signal);
+		histogram.push_back(snapshot.hist);
+	}
+};
+
+// Running RSI (Wilder smoothing) and MACD state for one series. update() is O(1), so the cost of keeping the
+// indicators current does not depend on how much history has been seen.
+class IndicatorState
+{
+  public:
+	static constexpr size_t rsi_period  = 14;
+	static constexpr size_t macd_fast   = 12;
+	static constexpr size_t macd_slow   = 26;
+	static constexpr size_t macd_signal = 9;
+
+	void update(double price)
+	{
+		if (m_samples == 0)
+		{
+			m_last	   = price;
+			m_ema_fast = price;
+			m_ema_slow = price;
+			m_samples  = 1;
+			return;
+		}
+
+		double delta = price - m_last;
+		double gain	 = delta > 0.0 ? delta : 0.0;
+		double loss	 = delta < 0.0 ? -delta : 0.0;
+		if (m_samples <= rsi_period)
+		{
+			m_avg_gain += gain / rsi_period;
+			m_avg_loss += loss / rsi_period;
+		}
+		else
+		{
+			m_avg_gain = (m_avg_gain * (rsi_period - 1) + gain) / rsi_period;
+			m_avg_loss = (m_avg_loss * (rsi_period - 1) + loss) / rsi_period;
+		}
+
+		m_ema_fast = alpha(macd_fast) * price + (1 - alpha(macd_fast)) * m_ema_fast;
+		m_ema_slow = alpha(macd_slow) * price + (1 - alpha(macd_slow)) * m_ema_slow;
+
+		m_last = price;
+		++m_samples;
+
+		if (m_samples == macd_slow)
+		{
+			m_signal = m_ema_fast - m_ema_slow;
+		}
+		else if (m_samples > macd_slow)
+		{
+			m_signal = alpha(macd_signal) * (m_ema_fast - m_ema_slow) + (1 - alpha(macd_signal)) * m_signal;
+		}
+	}
+
+	IndicatorSnapshot snapshot() const
+	{
+		IndicatorSnapshot out;
+		out.samples = m_samples;
+		if (m_samples > rsi_period)
+		{
+			out.rsi = m_avg_gain + m_avg_loss == 0.0 ? 50.0 : 100.0 * m_avg_gain / (m_avg_gain + m_avg_loss);
+		}
+		if (m_samples >= macd_slow)
+		{
+			out.macd   = m_ema_fast - m_ema_slow;
+			out.signal = m_signal;
+			out.hist   = out.macd - out.signal;
+		}
+		return out;
+	}
+
+  private:
+	static constexpr double alpha(size_t period) { return 2.0 / (static_cast<double>(period) + 1.0); }
+
+	size_t m_samples  = 0;
+	double m_last	  = 0.0;
+	double m_avg_gain = 0.0;
+	double m_avg_loss = 0.0;
+	double m_ema_fast = 0.0;
+	double m_ema_slow = 0.0;
+	double m_signal	  = 0.0;
+};
+
+void compute_macd(const std::vector<double>& prices, double& macd, double& signal)
+{
+	IndicatorState state;
+	for (double price : prices)
+	{
+		state.update(price);
+	}
+	IndicatorSnapshot snapshot = state.snapshot();
+	macd					   = snapshot.macd;
+	signal					   = snapshot.signal;
+}
+
+// One pass over the whole series; entries before the slow EMA has warmed up are zero. The returned state continues
+// the series incrementally.
+IndicatorState compute_macd_series(const std::vector<double>& prices, MacdSeries& out)
+{
+	out.clear();
+	out.macd.reserve(prices.size());
+	out.signal.reserve(prices.size());
+	out.histogram.reserve(prices.size());
+
+	IndicatorState state;
+	for (double price : prices)
+	{
+		state.update(price);
+		out.push_back(state.snapshot());
+	}
+	return state;
+}
+
+struct IndicatorSeries
+{
+	IndicatorState state;
+	IndicatorSnapshot last;
+	std::vector<double> times;
+	MacdSeries macd;
+};
+
+// Per-asset indicator series indexed by AssetId. A series is computed once over its loaded history and then advanced
+// bar by bar as live candles close; readers only look at the cached values.
+class IndicatorEngine
+{
+  public:
+	explicit IndicatorEngine(size_t max_points = 12096) : m_max_points(max_points) {}
+
+	bool contains(AssetId asset) const { return find(asset) != nullptr; }
+
+	void seed(AssetId asset, const std::vector<double>& times, const std::vector<double>& prices)
+	{
+		if (asset >= m_series.size())
+		{
+			m_series.resize(asset + 1);
+		}
+		if (!m_series[asset])
+		{
+			m_series[asset] = std::make_unique<IndicatorSeries>();
+		}
+
+		IndicatorSeries& series = *m_series[asset];
+		series.times			= times;
+		series.state			= compute_macd_series(prices, series.macd);
+		series.last				= series.state.snapshot();
+	}
+
+	// The newest bar is still forming, so only the ones before it are used; update_closed() picks it up once it closes.
+	void seed_closed(AssetId asset, const CandleSeries& bars)
+	{
+		std::vector<double> times;
+		std::vector<double> prices;
+		for (size_t idx_for_i = 0; idx_for_i + 1 < bars.size(); ++idx_for_i)
+		{
+			times.push_back(bars[idx_for_i].time);
+			prices.push_back(bars[idx_for_i].close);
+		}
+		seed(asset, times, prices);
+	}
+
+	// Feeds every bar that closed since the last one the series saw. Called per tick, but only does work once an hour.
+	void update_closed(AssetId asset, const CandleSeries& bars)
+	{
+		if (asset >= m_series.size() || !m_series[asset] || bars.size() < 2)
+		{
+			return;
+		}
+
+		const IndicatorSeries& series = *m_series[asset];
+		const double after			  = series.times.empty() ? -std::numeric_limits<double>::infinity() : series.times.back();
+		size_t first				  = bars.size() - 1;
+		while (first > 0 && bars[first - 1].time > after)
+		{
+			--first;
+		}
+		for (size_t idx_for_i = first; idx_for_i + 1 < bars.size(); ++idx_for_i)
+		{
+			update(asset, bars[idx_for_i].time, bars[idx_for_i].close);
+		}
+	}
+
+	void update(AssetId asset, double time, double price)
+	{
+		if (asset >= m_series.size() || !m_series[asset])
+		{
+			return;
+		}
+
+		IndicatorSeries& series = *m_series[asset];
+		series.state.update(price);
+		series.last = series.state.snapshot();
+		series.times.push_back(time);
+		series.macd.push_back(series.last);
+
+		if (series.times.size() > 2 * m_max_points)
+		{
+			size_t drop = series.times.size() - m_max_points;
+			series.times.erase(series.times.begin(), series.times.begin() + drop);
+			series.macd.macd.erase(series.macd.macd.begin(), series.macd.macd.begin() + drop);
+			series.macd.signal.erase(series.macd.signal.begin(), series.macd.signal.begin() + drop);
+			series.macd.histogram.erase(series.macd.histogram.begin(), series.macd.histogram.begin() + drop);
+		}
+	}
+
+	const IndicatorSeries* find(AssetId asset) const { return asset < m_series.size() ? m_series[asset].get() : nullptr; }
+
+	void erase(AssetId asset)
+	{
+		if (asset < m_series.size())
+		{
+			m_series[asset].reset();
+		}
+	}
+
+  private:
+	size_t m_max_points;
+	std::vector<std::unique_ptr<IndicatorSeries>> m_series;
+};
+
+#endif // INDICATORS_HPP
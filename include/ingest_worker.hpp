@@ -0,0 +1,194 @@
+#ifndef INGEST_WORKER_HPP
+#define INGEST_WORKER_HPP
+
+#include "coingecko.hpp"
+#include "poll_scheduler.hpp"
+#include "spsc_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Owns price polling on a dedicated thread. The UI hands watchlist and focus changes in through coalescing slots and
+// drains price snapshots out through an SPSC ring, so the render loop never blocks on the network. A PollScheduler
+// decides the cadence.
+class IngestWorker
+{
+  public:
+	explicit IngestWorker(PollPolicy policy = {}) : m_scheduler(policy) {}
+	IngestWorker(const IngestWorker&)			 = delete;
+	IngestWorker& operator=(const IngestWorker&) = delete;
+	~IngestWorker() { stop(); }
+
+	void start(const std::string& api_key)
+	{
+		if (m_thread.joinable())
+		{
+			return;
+		}
+		m_api_key = api_key;
+		m_stop	  = false;
+		m_thread  = std::thread(&IngestWorker::run, this);
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_wake_mutex);
+			m_stop = true;
+		}
+		m_wake_cv.notify_one();
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+	}
+
+	// Invoked on the ingest thread after each published snapshot. Set before start().
+	void set_on_publish(std::function<void()> on_publish) { m_on_publish = std::move(on_publish); }
+
+	// Paces history downloads from the poll budget: queued() is checked on every pass and submit_next() is called for
+	// each token granted. Set before start().
+	void set_history(std::function<size_t()> queued, std::function<bool()> submit_next)
+	{
+		m_history_queued	  = std::move(queued);
+		m_history_submit_next = std::move(submit_next);
+	}
+
+	// Any thread; makes the ingest thread re-check its inputs, e.g. after a history download was queued.
+	void wake()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_wake_mutex);
+			m_wake = true;
+		}
+		m_wake_cv.notify_one();
+	}
+
+	// UI thread only. Edits coalesce: the ingest thread picks up the latest list however many were set since its last
+	// pass, so a burst of edits can never leave it polling a stale one.
+	void set_watchlist(std::vector<std::string> watchlist)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_wake_mutex);
+			m_pending_watchlist = std::move(watchlist);
+			m_watchlist_pending = true;
+			m_wake				= true;
+		}
+		m_wake_cv.notify_one();
+	}
+
+	// UI thread only. An empty id clears the focus; coalesces like set_watchlist().
+	void set_focus(std::string id)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_wake_mutex);
+			m_pending_focus = std::move(id);
+			m_focus_pending = true;
+			m_wake			= true;
+		}
+		m_wake_cv.notify_one();
+	}
+
+	// UI thread only.
+	bool poll(PriceSnapshot& out) { return m_snapshots.pop(out); }
+
+  private:
+	void run()
+	{
+		std::vector<std::string> watchlist;
+		std::vector<std::string> focus;
+		size_t watchlist_cost = 0;
+
+		while (true)
+		{
+			std::vector<std::string> watchlist_update;
+			std::string focus_update;
+			bool watchlist_changed = false;
+			bool focus_changed	   = false;
+			{
+				std::lock_guard<std::mutex> lock(m_wake_mutex);
+				watchlist_update.swap(m_pending_watchlist);
+				focus_update.swap(m_pending_focus);
+				watchlist_changed	= m_watchlist_pending;
+				focus_changed		= m_focus_pending;
+				m_watchlist_pending = false;
+				m_focus_pending		= false;
+			}
+			if (watchlist_changed)
+			{
+				watchlist	   = std::move(watchlist_update);
+				watchlist_cost = shard_watchlist(watchlist).size();
+				m_scheduler.watchlist_changed();
+			}
+			if (focus_changed)
+			{
+				focus.assign(focus_update.empty() ? 0 : 1, focus_update);
+				m_scheduler.focus_changed();
+			}
+
+			auto now					= PollClock::now();
+			auto wake					= now;
+			const size_t history_queued = m_history_queued ? m_history_queued() : 0;
+			PollKind kind				= m_scheduler.next(now, watchlist_cost, focus.size(), history_queued, wake);
+			if (kind == PollKind::history)
+			{
+				m_history_submit_next();
+				wake = now;
+			}
+			else if (kind != PollKind::none)
+			{
+				PriceSnapshot snapshot;
+				FetchReport report;
+				if (fetch_watchlist_prices(kind == PollKind::watchlist ? watchlist : focus, m_api_key, snapshot, &report))
+				{
+					if (!m_snapshots.push(std::move(snapshot)))
+					{
+						std::cerr << "Ingest snapshot queue full, snapshot dropped\n";
+					}
+					else if (m_on_publish)
+					{
+						m_on_publish();
+					}
+				}
+				m_scheduler.record(PollClock::now(), kind, report);
+				wake = now;
+			}
+
+			std::unique_lock<std::mutex> lock(m_wake_mutex);
+			m_wake_cv.wait_until(lock, wake, [this] { return m_stop || m_wake; });
+			if (m_stop)
+			{
+				return;
+			}
+			m_wake = false;
+		}
+	}
+
+	PollScheduler m_scheduler;
+	std::string m_api_key;
+	std::function<void()> m_on_publish;
+	std::function<size_t()> m_history_queued;
+	std::function<bool()> m_history_submit_next;
+	std::thread m_thread;
+
+	SpscQueue<PriceSnapshot, 16> m_snapshots;
+
+	// Guarded by m_wake_mutex.
+	std::vector<std::string> m_pending_watchlist;
+	std::string m_pending_focus;
+	bool m_watchlist_pending = false;
+	bool m_focus_pending	 = false;
+
+	std::mutex m_wake_mutex;
+	std::condition_variable m_wake_cv;
+	bool m_stop = false;
+	bool m_wake = false;
+};
+
+#endif // INGEST_WORKER_HPP
@@ -0,0 +1,336 @@
+#ifndef JSON_STREAM_HPP
+#define JSON_STREAM_HPP
+
+#include <charconv>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Push-style JSON tokenizer that accepts the document in arbitrary chunks (e.g. straight from a curl write callback)
+// and reports SAX events to Handler without building a DOM. Structurally invalid input (a missing or extra ',' or
+// ':', a trailing comma, a value where a key belongs) fails the feed. Handler provides:
+//   start_object() end_object() start_array() end_array()
+//   key(std::string_view) string(std::string_view) number(double) literal()
+// String escapes other than \uXXXX are decoded; \u sequences are passed through verbatim, which is enough for the
+// ASCII ids and keys this client matches on.
+template <typename Handler>
+class JsonTokenizer
+{
+  public:
+	explicit JsonTokenizer(Handler& handler) : m_handler(handler) {}
+
+	bool feed(const char* data, size_t size)
+	{
+		for (size_t idx_for_i = 0; idx_for_i < size && !m_error; ++idx_for_i)
+		{
+			consume(data[idx_for_i]);
+		}
+		return !m_error;
+	}
+
+	// Flushes a trailing top-level number and reports whether a complete document was seen.
+	bool finish()
+	{
+		if (m_state == State::number)
+		{
+			end_number();
+		}
+		else if (m_state == State::literal)
+		{
+			end_literal();
+		}
+		return !m_error && m_done && m_stack.empty() && m_state == State::value;
+	}
+
+	bool failed() const { return m_error; }
+
+  private:
+	enum class State
+	{
+		value,
+		string,
+		string_escape,
+		number,
+		literal
+	};
+
+	// What may come next inside an open object or array.
+	enum class Expect
+	{
+		key_or_end,
+		key,
+		colon,
+		value_or_end,
+		value,
+		comma_or_end
+	};
+
+	struct Frame
+	{
+		bool object;
+		Expect expect;
+	};
+
+	void consume(char c)
+	{
+		switch (m_state)
+		{
+		case State::string:
+			if (c == '"')
+			{
+				end_string();
+			}
+			else if (c == '\\')
+			{
+				m_state = State::string_escape;
+			}
+			else
+			{
+				m_token.push_back(c);
+			}
+			return;
+
+		case State::string_escape:
+			m_token.push_back(unescape(c));
+			m_state = State::string;
+			return;
+
+		case State::number:
+			if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')
+			{
+				m_token.push_back(c);
+				return;
+			}
+			end_number();
+			break;
+
+		case State::literal:
+			if (c >= 'a' && c <= 'z')
+			{
+				m_token.push_back(c);
+				return;
+			}
+			end_literal();
+			break;
+
+		case State::value:
+			break;
+		}
+
+		if (m_error)
+		{
+			return;
+		}
+		structural(c);
+	}
+
+	void structural(char c)
+	{
+		switch (c)
+		{
+		case ' ':
+		case '\t':
+		case '\n':
+		case '\r':
+			return;
+		case '{':
+			begin_value();
+			m_stack.push_back({true, Expect::key_or_end});
+			m_handler.start_object();
+			return;
+		case '[':
+			begin_value();
+			m_stack.push_back({false, Expect::value_or_end});
+			m_handler.start_array();
+			return;
+		case '}':
+			if (m_stack.empty() || !m_stack.back().object || (m_stack.back().expect != Expect::key_or_end && m_stack.back().expect != Expect::comma_or_end))
+			{
+				m_error = true;
+				return;
+			}
+			m_stack.pop_back();
+			m_handler.end_object();
+			end_value();
+			return;
+		case ']':
+			if (m_stack.empty() || m_stack.back().object || (m_stack.back().expect != Expect::value_or_end && m_stack.back().expect != Expect::comma_or_end))
+			{
+				m_error = true;
+				return;
+			}
+			m_stack.pop_back();
+			m_handler.end_array();
+			end_value();
+			return;
+		case ':':
+			if (m_stack.empty() || m_stack.back().expect != Expect::colon)
+			{
+				m_error = true;
+				return;
+			}
+			m_stack.back().expect = Expect::value;
+			return;
+		case ',':
+			if (m_stack.empty() || m_stack.back().expect != Expect::comma_or_end)
+			{
+				m_error = true;
+				return;
+			}
+			m_stack.back().expect = m_stack.back().object ? Expect::key : Expect::value;
+			return;
+		case '"':
+			m_string_is_key = expecting_key();
+			if (!m_string_is_key)
+			{
+				begin_value();
+			}
+			m_token.clear();
+			m_state = State::string;
+			return;
+		default:
+			if ((c >= '0' && c <= '9') || c == '-')
+			{
+				begin_value();
+				m_token.clear();
+				m_token.push_back(c);
+				m_state = State::number;
+			}
+			else if (c == 't' || c == 'f' || c == 'n')
+			{
+				begin_value();
+				m_token.clear();
+				m_token.push_back(c);
+				m_state = State::literal;
+			}
+			else
+			{
+				m_error = true;
+			}
+			return;
+		}
+	}
+
+	bool expecting_key() const { return !m_stack.empty() && m_stack.back().object && (m_stack.back().expect == Expect::key_or_end || m_stack.back().expect == Expect::key); }
+
+	// A value may only start at the top level (once) or where its container expects one.
+	void begin_value()
+	{
+		if (m_stack.empty())
+		{
+			m_error = m_error || m_done;
+			return;
+		}
+		Frame& frame = m_stack.back();
+		if (frame.expect != Expect::value && frame.expect != Expect::value_or_end)
+		{
+			m_error = true;
+			return;
+		}
+		frame.expect = Expect::comma_or_end;
+	}
+
+	void end_value()
+	{
+		if (m_stack.empty())
+		{
+			m_done = true;
+		}
+	}
+
+	void end_string()
+	{
+		m_state = State::value;
+		if (m_string_is_key)
+		{
+			m_stack.back().expect = Expect::colon;
+			m_handler.key(std::string_view(m_token));
+			return;
+		}
+		m_handler.string(std::string_view(m_token));
+		end_value();
+	}
+
+	void end_number()
+	{
+		m_state		 = State::value;
+		double value = 0.0;
+		auto result	 = std::from_chars(m_token.data(), m_token.data() + m_token.size(), value);
+		if (result.ec != std::errc() || result.ptr != m_token.data() + m_token.size())
+		{
+			m_error = true;
+			return;
+		}
+		m_handler.number(value);
+		end_value();
+	}
+
+	void end_literal()
+	{
+		m_state = State::value;
+		if (m_token != "true" && m_token != "false" && m_token != "null")
+		{
+			m_error = true;
+			return;
+		}
+		m_handler.literal();
+		end_value();
+	}
+
+	static char unescape(char c)
+	{
+		switch (c)
+		{
+		case 'n':
+			return '\n';
+		case 't':
+			return '\t';
+		case 'r':
+			return '\r';
+		case 'b':
+			return '\b';
+		case 'f':
+			return '\f';
+		default:
+			return c;
+		}
+	}
+
+	Handler& m_handler;
+	State m_state = State::value;
+	std::string m_token;
+	std::vector<Frame> m_stack;
+	bool m_string_is_key = false;
+	bool m_done			 = false;
+	bool m_error		 = false;
+};
+
+// Owns a handler together with the tokenizer feeding it, so both can live in one shared_ptr captured by a callback.
+template <typename Handler>
+struct JsonStream
+{
+	template <typename... Args>
+	explicit JsonStream(Args&&... args) : handler(std::forward<Args>(args)...), tokenizer(handler)
+	{
+	}
+
+	JsonStream(const JsonStream&)			 = delete;
+	JsonStream& operator=(const JsonStream&) = delete;
+
+	// Time spent tokenizing is accumulated across chunks, so it can be reported apart from the network wait.
+	bool feed(const char* data, size_t size)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const bool ok	 = tokenizer.feed(data, size);
+		parse_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return ok;
+	}
+
+	Handler handler;
+	JsonTokenizer<Handler> tokenizer;
+	double parse_seconds = 0.0;
+};
+
+#endif // JSON_STREAM_HPP
@@ -0,0 +1,270 @@
+#ifndef LOD_HPP
+#define LOD_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+struct LodBucket
+{
+	double t_start;
+	double t_end;
+	double t_min;
+	double t_max;
+	double min;
+	double max;
+	double last;
+	size_t count;
+};
+
+// Reusable output of a LOD query; the vectors keep their capacity, so steady-state queries do not allocate.
+struct LodView
+{
+	std::vector<double> xs;
+	std::vector<double> ys;
+
+	void clear()
+	{
+		xs.clear();
+		ys.clear();
+	}
+
+	void push(double x, double y)
+	{
+		xs.push_back(x);
+		ys.push_back(y);
+	}
+
+	int size() const { return static_cast<int>(xs.size()); }
+};
+
+// Min/max/last pyramid over an append-only series. Level k summarises lod_fanout^(k+1) raw points per bucket and
+// is updated in O(levels) per append. With a non-zero raw capacity every level is a ring sized to cover the same
+// window as the raw ring; with capacity zero the levels grow without bound (static series).
+class LodPyramid
+{
+  public:
+	static constexpr size_t lod_fanout = 4;
+	static constexpr size_t lod_levels = 7;
+
+	explicit LodPyramid(size_t raw_capacity = 0)
+	{
+		size_t span = 1;
+		for (auto& level : m_levels)
+		{
+			span *= lod_fanout;
+			level.span	   = span;
+			level.capacity = raw_capacity == 0 ? 0 : raw_capacity / span + 2;
+		}
+	}
+
+	void append(double t, double price)
+	{
+		for (auto& level : m_levels)
+		{
+			LodBucket& open = level.open;
+			if (open.count == 0)
+			{
+				open = {t, t, t, t, price, price, price, 0};
+			}
+			if (price < open.min)
+			{
+				open.min   = price;
+				open.t_min = t;
+			}
+			if (price > open.max)
+			{
+				open.max   = price;
+				open.t_max = t;
+			}
+			open.t_end = t;
+			open.last  = price;
+			if (++open.count == level.span)
+			{
+				level.push(open);
+				open.count = 0;
+			}
+		}
+	}
+
+	template <typename Xs, typename Ys>
+	void build(const Xs& times, const Ys& prices)
+	{
+		*this = LodPyramid(0);
+		for (size_t idx_for_i = 0; idx_for_i < times.size(); ++idx_for_i)
+		{
+			append(times[idx_for_i], prices[idx_for_i]);
+		}
+	}
+
+	// Fills out with at most ~2 points per pixel covering [t0, t1] (plus one neighbour on each side). raw must
+	// provide size(), timestamp(i) and price(i) for the series the pyramid was built from. When the window does not
+	// overlap the data the whole series is returned, so a plot's initial fit still sees everything.
+	template <typename Raw>
+	void query(const Raw& raw, double t0, double t1, int pixels, LodView& out) const
+	{
+		out.clear();
+		const size_t count = raw.size();
+		if (count == 0)
+		{
+			return;
+		}
+		if (t1 < raw.timestamp(0) || t0 > raw.timestamp(count - 1) || t1 <= t0)
+		{
+			t0 = raw.timestamp(0);
+			t1 = raw.timestamp(count - 1);
+		}
+
+		const size_t budget = static_cast<size_t>(std::max(pixels, 1)) * 2;
+		const size_t first	= lower_bound(raw, t0);
+		const size_t last	= std::min(count, upper_bound(raw, t1) + 1);
+		const size_t begin	= first > 0 ? first - 1 : 0;
+
+		if (last - begin <= budget)
+		{
+			for (size_t idx_for_i = begin; idx_for_i < last; ++idx_for_i)
+			{
+				out.push(raw.timestamp(idx_for_i), raw.price(idx_for_i));
+			}
+			return;
+		}
+
+		const Level* chosen = &m_levels.back();
+		for (const auto& level : m_levels)
+		{
+			if ((last - begin) / level.span <= budget / 2 && level.size() > 0)
+			{
+				chosen = &level;
+				break;
+			}
+		}
+		emit(*chosen, t0, t1, out);
+	}
+
+  private:
+	struct Level
+	{
+		size_t span		= 0;
+		size_t capacity = 0;
+		size_t head		= 0;
+		std::vector<LodBucket> buckets;
+		LodBucket open{};
+
+		size_t size() const { return buckets.size(); }
+		const LodBucket& at(size_t index) const { return buckets[capacity == 0 ? index : (head + index) % buckets.size()]; }
+
+		void push(const LodBucket& bucket)
+		{
+			if (capacity == 0 || buckets.size() < capacity)
+			{
+				buckets.push_back(bucket);
+				return;
+			}
+			buckets[head] = bucket;
+			head		  = (head + 1) % capacity;
+		}
+	};
+
+	static void emit_bucket(const LodBucket& bucket, LodView& out)
+	{
+		if (bucket.t_min <= bucket.t_max)
+		{
+			out.push(bucket.t_min, bucket.min);
+			out.push(bucket.t_max, bucket.max);
+		}
+		else
+		{
+			out.push(bucket.t_max, bucket.max);
+			out.push(bucket.t_min, bucket.min);
+		}
+		out.push(bucket.t_end, bucket.last);
+	}
+
+	static void emit(const Level& level, double t0, double t1, LodView& out)
+	{
+		size_t lo = 0;
+		size_t hi = level.size();
+		while (lo < hi)
+		{
+			size_t mid = lo + (hi - lo) / 2;
+			if (level.at(mid).t_end < t0)
+			{
+				lo = mid + 1;
+			}
+			else
+			{
+				hi = mid;
+			}
+		}
+
+		for (size_t idx_for_i = lo > 0 ? lo - 1 : 0; idx_for_i < level.size(); ++idx_for_i)
+		{
+			const LodBucket& bucket = level.at(idx_for_i);
+			emit_bucket(bucket, out);
+			if (bucket.t_start > t1)
+			{
+				return;
+			}
+		}
+		if (level.open.count > 0)
+		{
+			emit_bucket(level.open, out);
+		}
+	}
+
+	template <typename Raw>
+	static size_t lower_bound(const Raw& raw, double t)
+	{
+		size_t lo = 0;
+		size_t hi = raw.size();
+		while (lo < hi)
+		{
+			size_t mid = lo + (hi - lo) / 2;
+			if (raw.timestamp(mid) < t)
+			{
+				lo = mid + 1;
+			}
+			else
+			{
+				hi = mid;
+			}
+		}
+		return lo;
+	}
+
+	template <typename Raw>
+	static size_t upper_bound(const Raw& raw, double t)
+	{
+		size_t lo = 0;
+		size_t hi = raw.size();
+		while (lo < hi)
+		{
+			size_t mid = lo + (hi - lo) / 2;
+			if (raw.timestamp(mid) <= t)
+			{
+				lo = mid + 1;
+			}
+			else
+			{
+				hi = mid;
+			}
+		}
+		return lo;
+	}
+
+	std::array<Level, lod_levels> m_levels;
+};
+
+// Adapts a pair of parallel vectors to the raw interface LodPyramid::query expects.
+struct VectorSeriesView
+{
+	const std::vector<double>& times;
+	const std::vector<double>& prices;
+
+	size_t size() const { return times.size(); }
+	double timestamp(size_t index) const { return times[index]; }
+	double price(size_t index) const { return prices[index]; }
+};
+
+#endif // LOD_HPP
@@ -6,180 +6,80 @@
 #include "../lib/imgui/backends/imgui_impl_sdl2.h"
 #include "../lib/imgui/imgui.h"
 #include "../lib/implot/implot.h"
+#include "../lib/implot/implot_internal.h"
+#include "alloc_counter.hpp"
+#include "asset_rows.hpp"
+#include "market_bus.hpp"
+#include "market_state.hpp"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_opengl.h>
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
 #include <curl/curl.h>
-#include <deque>
 #include <fstream>
 #include <iostream>
-#include <nlohmann/json.hpp>
+#include <limits>
 #include <string>
 
-using json = nlohmann::json;
-
 float g_price_now  = 0.0F;
 float g_price_high = 0.0F;
-std::string g_api_key;
-std::chrono::time_point<std::chrono::steady_clock> g_last_fetch;
 
 char g_crypto_id[64]	= "bitcoin";
 char g_input_crypto[64] = "";
-std::vector<std::string> g_crypto_watchlist;
-std::map<std::string, float> g_prices;
 
-std::string g_focused_crypto = "";
+AssetId g_focused_asset = no_asset;
 
-struct PricePoint
-{
-	double timestamp;
-	float price;
-};
+// With --bus prices come from a local daemon through the shared-memory bus instead of this process polling.
+bool g_bus_mode = false;
+MarketBusReader g_market_bus;
+MarketBusWatcher g_market_bus_watcher;
 
-std::map<std::string, std::deque<PricePoint>> g_price_history_map;
+// Latency overlay, toggled with F3 or --profile; --profile-dump also writes the stats there on exit.
+bool g_show_profiler			= false;
+std::string g_profile_dump_path = "data/profile.json";
 
-size_t curl_write(void* contents, size_t size, size_t nmemb, std::string* output)
-{
-	output->append((char*)contents, size * nmemb);
-	return size * nmemb;
-}
+bool g_on_demand_render = true;
+Uint32 g_wake_event		= static_cast<Uint32>(-1);
+std::atomic<bool> g_wake_pending{false};
 
-std::string read_api_key()
+// Safe to call from any thread; wakes the render loop out of SDL_WaitEventTimeout. Wake-ups are coalesced until the
+// loop has seen the pending one.
+void request_redraw()
 {
-	const char* cmd = "gpg --quiet --batch --yes --decrypt config/apikey.txt.gpg 2>/dev/null";
-	FILE* pipe		= popen(cmd, "r");
-	if (!pipe)
+	if (g_wake_event == static_cast<Uint32>(-1) || g_wake_pending.exchange(true))
 	{
-		std::cerr << "Failed to run gpg command. \n";
-		return "";
-	}
-
-	std::ostringstream key_stream;
-	char buffer[128];
-	while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
-	{
-		key_stream << buffer;
+		return;
 	}
-	pclose(pipe);
-
-	return key_stream.str();
+	SDL_Event event{};
+	event.type = g_wake_event;
+	SDL_PushEvent(&event);
 }
 
-void fetch_watchlist_prices()
+void set_focused_asset(AssetId asset)
 {
-	if (g_crypto_watchlist.empty())
-	{
-		return;
-	}
-
-	std::string ids;
-	for (const auto& id : g_crypto_watchlist)
-	{
-		if (!ids.empty())
-		{
-			ids += ",";
-		}
-		ids += id;
-	}
-
-	std::string url = "https://api.coingecko.com/api/v3/simple/price?ids=" + ids + "&vs_currencies=usd";
-
-	CURL* curl = curl_easy_init();
-	if (!curl)
-	{
-		return;
-	}
-
-	std::string response;
-
-	struct curl_slist* headers = nullptr;
-	std::string auth_header	   = "x-cg-demo-api-key: " + g_api_key;
-	headers					   = curl_slist_append(headers, auth_header.c_str());
-
-	std::cout << "URL: " << url << "\n";
-
-	curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_write);
-	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-	curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L);
-	curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-
-	CURLcode res = curl_easy_perform(curl);
-	if (res == CURLE_OK)
-	{
-		try
-		{
-			auto parsed = json::parse(response);
-			for (const auto& id : g_crypto_watchlist)
-			{
-				if (parsed.contains(id) && parsed[id].contains("usd"))
-				{
-					g_prices[id] = parsed[id]["usd"].get<float>();
-
-					double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
-
-					g_price_history_map[id].push_back({now, g_prices[id]});
-
-					while (g_price_history_map[id].size() > 12096)
-					{
-						g_price_history_map[id].pop_front();
-					}
-				}
-			}
-		}
-		catch (std::exception& e)
-		{
-			std::cerr << "JSON parsing error: " << e.what() << "\nResponse: " << response << "\n";
-		}
-	}
-	else
+	g_focused_asset = asset;
+	if (!g_bus_mode)
 	{
-		std::cerr << "CURL error: " << curl_easy_strerror(res) << "\n";
+		g_ingest.set_focus(asset == no_asset ? std::string() : g_assets.name(asset));
 	}
-
-	curl_slist_free_all(headers);
-	curl_easy_cleanup(curl);
 }
 
-bool fetch_crypto_history(const std::string& id, std::vector<double>& out_times, std::vector<double>& out_prices)
+// In bus mode the daemon polls; it picks the edit up from the saved watchlist file.
+void on_watchlist_changed()
 {
-	std::string url = "https://api.coingecko.com/api/v3/coins/" + id + "/market_chart?vs_currency=usd&days=7";
-	CURL* curl		= curl_easy_init();
-	if (!curl)
+	if (!g_bus_mode)
 	{
-		return false;
-	}
-
-	std::string response;
-	curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_write);
-	curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-	curl_easy_perform(curl);
-	curl_easy_cleanup(curl);
-
-	try
-	{
-		json parsed = json::parse(response);
-		if (!parsed.contains("prices"))
-		{
-			return false;
-		}
-		for (auto& p : parsed["prices"])
-		{
-			out_times.push_back(p[0].get<double>() / 1000.0);
-			out_prices.push_back(p[1].get<double>());
-		}
-		return true;
-	}
-	catch (...)
-	{
-		return false;
+		g_ingest.set_watchlist(g_crypto_watchlist);
 	}
+	g_watchlist_persister.schedule(g_crypto_watchlist);
+	rebuild_asset_rows();
 }
 
+// With --bus history comes from the local store (see store_history), so viewers add no market_chart traffic.
+HistoryHandle request_history(const std::string& id, int days) { return g_bus_mode ? store_history(g_assets.intern(id), days) : g_history.request(id, days); }
+
 int format_timestamp(double value, char* buffer, int size, void*)
 {
 	std::time_t t = static_cast<std::time_t>(value);
@@ -191,66 +91,119 @@ int format_timestamp(double value, char* buffer, int size, void*)
 	return 0;
 }
 
-float compute_rsi(const std::vector<double>& prices, size_t period = 14)
+// Plots a downsampled line for the current plot window; call between BeginPlot/setup and EndPlot.
+template <typename Raw>
+void plot_lod_line(const char* label, const Raw& raw, const LodPyramid& lod, LodView& view)
+{
+	ImPlotRect limits = ImPlot::GetPlotLimits();
+	int pixels		  = static_cast<int>(ImPlot::GetPlotSize().x);
+	lod.query(raw, limits.X.Min, limits.X.Max, pixels, view);
+	ImPlot::PlotLine(label, view.xs.data(), view.ys.data(), view.size());
+}
+
+// Archive ticks that predate the ring, decoded into their own pyramid. The ring start moves forward on every tick once
+// the ring is full, so the view is extended up to it incrementally: each refresh decodes only the ticks the ring has
+// dropped since the last one.
+struct ArchiveView
 {
-	if (prices.size() < period + 1)
+	AssetId asset		 = no_asset;
+	double decoded_until = 0.0;
+	std::vector<double> times;
+	std::vector<double> prices;
+	LodPyramid lod;
+};
+
+void refresh_archive_view(AssetId asset, const TimeSeries& recent, ArchiveView& view)
+{
+	const CompressedSeries* archive = g_price_history.find_archive(asset);
+	const bool expired				= archive && !view.times.empty() && to_millis(view.times.front()) < archive->first_ms();
+	if (view.asset != asset || !archive || expired)
 	{
-		return 0.0;
+		view.asset = asset;
+		view.times.clear();
+		view.prices.clear();
+		view.lod		   = LodPyramid();
+		view.decoded_until = 0.0;
 	}
-	double gain = 0.0, loss = 0.0;
-	for (size_t idx_for_i = prices.size() - period; idx_for_i < prices.size(); ++idx_for_i)
+	if (!archive || archive->first_ms() == INT64_MIN || recent.empty())
 	{
-		double delta = prices[idx_for_i + 1] - prices[idx_for_i];
-		if (delta >= 0)
-		{
-			gain += delta;
-		}
-		else
-		{
-			loss -= delta;
-		}
+		return;
 	}
-	if (gain + loss == 0.0)
+
+	// The live line draws the ring itself.
+	const double ring_start = recent.timestamp(0);
+	const double since		= view.times.empty() ? static_cast<double>(archive->first_ms()) / 1000.0 : view.decoded_until;
+	if (ring_start <= since)
 	{
-		return 50.0;
+		return;
 	}
-	double rs = gain / loss;
-	return 100.0 - (100.0 / (1.0 + rs));
+	archive->for_each_between(since, ring_start,
+							  [&](double timestamp, float price)
+							  {
+								  view.times.push_back(timestamp);
+								  view.prices.push_back(price);
+								  view.lod.append(timestamp, price);
+							  });
+	view.decoded_until = ring_start;
 }
 
-void compute_macd(const std::vector<double>& prices, double& macd, double& signal)
+// Custom candlestick item drawn straight into the plot draw list; only bars opening before `before` are drawn, so a
+// history series can be stitched in front of the live one. Bars outside the visible X range are culled.
+void plot_candles(const char* label, const CandleSeries& series, double before)
 {
-	if (prices.size() < 26)
+	if (series.empty() || !ImPlot::BeginItem(label))
 	{
-		macd = signal = 0.0;
 		return;
 	}
 
-	double ema12   = prices[0];
-	double ema26   = prices[0];
-	double alpha12 = 2.0 / (12.0 + 1);
-	double alpha26 = 2.0 / (26.0 + 1);
-	for (size_t idx_for_i = 1; idx_for_i < prices.size(); ++idx_for_i)
+	const double half = series.interval() * 0.4;
+	if (ImPlot::FitThisFrame())
 	{
-		ema12 = alpha12 * prices[idx_for_i] + (1 - alpha12) * ema12;
-		ema26 = alpha26 * prices[idx_for_i] + (1 - alpha26) * ema26;
+		for (size_t idx_for_i = 0; idx_for_i < series.size() && series[idx_for_i].time < before; ++idx_for_i)
+		{
+			const Candle& candle = series[idx_for_i];
+			ImPlot::FitPoint(ImPlotPoint(candle.time - half, candle.low));
+			ImPlot::FitPoint(ImPlotPoint(candle.time + half, candle.high));
+		}
 	}
 
-	macd = ema12 - ema26;
-	static std::vector<double> macd_history;
-	macd_history.push_back(macd);
-	if (macd_history.size() > 9)
+	const ImU32 bull_color = ImGui::GetColorU32(ImVec4(0.000F, 1.000F, 0.441F, 1.000F));
+	const ImU32 bear_color = ImGui::GetColorU32(ImVec4(0.853F, 0.050F, 0.310F, 1.000F));
+	ImPlotRect limits	   = ImPlot::GetPlotLimits();
+	ImDrawList* draw_list  = ImPlot::GetPlotDrawList();
+	for (size_t idx_for_i = 0; idx_for_i < series.size(); ++idx_for_i)
 	{
-		macd_history.erase(macd_history.begin());
+		const Candle& candle = series[idx_for_i];
+		if (candle.time >= before || candle.time - half > limits.X.Max)
+		{
+			break;
+		}
+		if (candle.time + half < limits.X.Min)
+		{
+			continue;
+		}
+
+		const ImU32 color = candle.close >= candle.open ? bull_color : bear_color;
+		ImVec2 open_pos	  = ImPlot::PlotToPixels(candle.time - half, candle.open);
+		ImVec2 close_pos  = ImPlot::PlotToPixels(candle.time + half, candle.close);
+		ImVec2 low_pos	  = ImPlot::PlotToPixels(candle.time, candle.low);
+		ImVec2 high_pos	  = ImPlot::PlotToPixels(candle.time, candle.high);
+		draw_list->AddLine(low_pos, high_pos, color);
+		if (close_pos.x - open_pos.x >= 1.0F)
+		{
+			draw_list->AddRectFilled(open_pos, close_pos, color);
+		}
 	}
-	signal = std::accumulate(macd_history.begin(), macd_history.end(), 0.0) / macd_history.size();
+
+	ImPlot::EndItem();
 }
 
-void analyze_crypto(const std::vector<double>& times, const std::vector<double>& prices)
+void analyze_crypto(const IndicatorSeries& series)
 {
-	float rsi	= compute_rsi(prices);
-	double macd = 0.0, signal = 0.0;
-	compute_macd(prices, macd, signal);
+	const IndicatorSnapshot& indicators = series.last;
+	double rsi							= indicators.rsi;
+	double macd							= indicators.macd;
+	double signal						= indicators.signal;
 
 	ImGui::Text("RSI: %.2f%s", rsi, (rsi > 70 ? " (Overbought)" : (rsi < 30 ? " (Oversold)" : "")));
 	ImGui::Text("MACD: %.4f", macd);
@@ -267,47 +220,92 @@ void analyze_crypto(const std::vector<double>& times, const std::vector<double>&
 	{
 		ImGui::Text("Signal: HOLD");
 	}
-}
 
-void save_watchlist(const std::string& path)
-{
-	std::ofstream file(path);
-	if (!file)
+	const size_t warmup = IndicatorState::macd_slow - 1;
+	if (series.times.size() <= warmup + 1)
 	{
-		std::cerr << "Failed to save watchlist to " << path << "\n";
 		return;
 	}
 
-	for (const auto& id : g_crypto_watchlist)
+	const int count		  = static_cast<int>(series.times.size() - warmup);
+	const double* times	  = series.times.data() + warmup;
+	const double bar_size = 0.8 * (series.times.back() - times[0]) / count;
+
+	if (ImPlot::BeginPlot("MACD", ImVec2(-1, 200)))
 	{
-		file << id << "\n";
+		ImPlot::SetupAxes("Date", nullptr, ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+		ImPlot::SetupAxisFormat(ImAxis_X1, format_timestamp);
+		ImPlot::PlotBars("Histogram", times, series.macd.histogram.data() + warmup, count, bar_size);
+		ImPlot::PlotLine("MACD", times, series.macd.macd.data() + warmup, count);
+		ImPlot::PlotLine("Signal", times, series.macd.signal.data() + warmup, count);
+		ImPlot::EndPlot();
 	}
 }
 
-void load_watchlist(const std::string& path)
+// Rolling per-zone latencies from g_profiler plus a histogram of the selected zone's recent samples.
+void draw_profiler_overlay(const ImGuiIO& io)
 {
+	static std::vector<float> scratch;
+	static std::vector<float> samples;
+	static int selected_zone = static_cast<int>(ProfileZone::frame);
+
+	ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x - 440, 20), ImGuiCond_FirstUseEver);
+	ImGui::SetNextWindowSize(ImVec2(420, 380), ImGuiCond_FirstUseEver);
+	ImGui::SetNextWindowBgAlpha(0.85F);
+	if (!ImGui::Begin("Profiler", &g_show_profiler))
+	{
+		ImGui::End();
+		return;
+	}
 
-	std::filesystem::create_directories(std::filesystem::path(path).parent_path());
-	if (!std::filesystem::exists(path))
+	if (ImGui::BeginTable("##zones", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
 	{
-		std::ofstream create_file(path);
-		if (!create_file)
+		ImGui::TableSetupColumn("zone");
+		ImGui::TableSetupColumn("calls");
+		ImGui::TableSetupColumn("last ms");
+		ImGui::TableSetupColumn("p50 ms");
+		ImGui::TableSetupColumn("p99 ms");
+		ImGui::TableSetupColumn("max ms");
+		ImGui::TableHeadersRow();
+		for (size_t idx_for_i = 0; idx_for_i < profile_zone_count; ++idx_for_i)
 		{
-			std::cerr << "Failed to create watchlist file at " << path << "\n";
-			return;
+			const ProfileStats stats = g_profiler.stats(static_cast<ProfileZone>(idx_for_i), scratch);
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			if (ImGui::Selectable(profile_zone_names[idx_for_i], selected_zone == static_cast<int>(idx_for_i)))
+			{
+				selected_zone = static_cast<int>(idx_for_i);
+			}
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(stats.count));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", stats.last_ms);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", stats.p50_ms);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", stats.p99_ms);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", stats.max_ms);
 		}
-		return;
+		ImGui::EndTable();
 	}
 
-	std::ifstream file(path);
-	std::string line;
+	g_profiler.samples(static_cast<ProfileZone>(selected_zone), samples);
+	if (!samples.empty() && ImPlot::BeginPlot("##latency", ImVec2(-1, 180)))
+	{
+		ImPlot::SetupAxes("ms", "calls", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+		ImPlot::PlotHistogram(profile_zone_names[static_cast<size_t>(selected_zone)], samples.data(), static_cast<int>(samples.size()), 40);
+		ImPlot::EndPlot();
+	}
 
-	while (std::getline(file, line))
+	if (ImGui::Button("Dump"))
 	{
-		std::transform(line.begin(), line.end(), line.begin(), ::tolower);
-		if (!line.empty() && std::find(g_crypto_watchlist.begin(), g_crypto_watchlist.end(), line) == g_crypto_watchlist.end())
-			g_crypto_watchlist.push_back(line);
+		g_profiler.dump(g_profile_dump_path, g_tick_clock.now());
 	}
+	ImGui::SameLine();
+	ImGui::TextDisabled("%s", g_profile_dump_path.c_str());
+
+	ImGui::End();
 }
 
 #endif // MAIN_HPP
@@ -0,0 +1,97 @@
+#ifndef MARKET_BOARD_HPP
+#define MARKET_BOARD_HPP
+
+#include "asset_registry.hpp"
+#include "rcu.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+constexpr size_t board_chunk_size = 64;
+
+// Latest quotes of board_chunk_size consecutive AssetIds. Boards share chunks, so a publish only copies the chunks
+// that a snapshot actually touched.
+struct BoardChunk
+{
+	std::array<float, board_chunk_size> prices{};
+	std::array<double, board_chunk_size> times{};
+};
+
+// Immutable view of the latest quote per asset, indexed by AssetId. Published through an RcuCell, so readers on any
+// thread get a consistent board without taking a lock.
+struct MarketBoard
+{
+	uint64_t sequence = 0;
+	double timestamp  = 0.0;
+	size_t count	  = 0;
+	// Shared between boards and only replaced when new assets are interned.
+	std::shared_ptr<const std::vector<std::string>> names;
+	std::vector<std::shared_ptr<const BoardChunk>> chunks;
+
+	size_t size() const { return count; }
+	float price(AssetId asset) const { return asset < count ? chunks[asset / board_chunk_size]->prices[asset % board_chunk_size] : 0.0F; }
+	double time(AssetId asset) const { return asset < count ? chunks[asset / board_chunk_size]->times[asset % board_chunk_size] : 0.0; }
+};
+
+using MarketBoardCell = RcuCell<MarketBoard>;
+
+// Writer side: starts from the previous board's chunk table, copies a chunk the first time a quote in it changes and
+// publishes the result. Lives on the single thread that applies snapshots.
+class MarketBoardWriter
+{
+  public:
+	explicit MarketBoardWriter(MarketBoardCell& cell) : m_cell(cell) {}
+
+	void begin(double timestamp)
+	{
+		const MarketBoard* previous = m_cell.current();
+		m_next						= previous ? std::make_unique<MarketBoard>(*previous) : std::make_unique<MarketBoard>();
+		m_next->sequence			= previous ? previous->sequence + 1 : 1;
+		m_next->timestamp			= timestamp;
+		m_writable.assign(m_next->chunks.size(), nullptr);
+	}
+
+	void set(AssetId asset, float price, double time)
+	{
+		const size_t chunk = asset / board_chunk_size;
+		const size_t index = asset % board_chunk_size;
+		if (chunk >= m_next->chunks.size())
+		{
+			m_next->chunks.resize(chunk + 1);
+			m_writable.resize(chunk + 1, nullptr);
+		}
+		if (!m_writable[chunk])
+		{
+			// Chunks still shared with published boards are never written; this board gets its own copy.
+			const BoardChunk* shared = m_next->chunks[chunk].get();
+			auto copy				 = shared ? std::make_shared<BoardChunk>(*shared) : std::make_shared<BoardChunk>();
+			m_writable[chunk]		 = copy.get();
+			m_next->chunks[chunk]	 = std::move(copy);
+		}
+		m_writable[chunk]->prices[index] = price;
+		m_writable[chunk]->times[index]	 = time;
+		m_next->count					 = std::max<size_t>(m_next->count, asset + 1);
+	}
+
+	void publish(const AssetRegistry& assets)
+	{
+		if (!m_next->names || m_next->names->size() != assets.size())
+		{
+			m_next->names = std::make_shared<const std::vector<std::string>>(assets.names());
+		}
+		m_writable.clear();
+		m_cell.publish(std::move(m_next));
+	}
+
+  private:
+	MarketBoardCell& m_cell;
+	std::unique_ptr<MarketBoard> m_next;
+	// Chunks of m_next already copied during this snapshot, by chunk index.
+	std::vector<BoardChunk*> m_writable;
+};
+
+#endif // MARKET_BOARD_HPP
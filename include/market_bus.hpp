@@ -0,0 +1,512 @@
+#ifndef MARKET_BUS_HPP
+#define MARKET_BUS_HPP
+
+#include "coingecko.hpp"
+#include "tick_clock.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Shared-memory market data bus. One ingest process (the daemon) owns the segment and publishes the latest quote
+// and a short tick ring per asset; any number of viewers map it read-only. Every field is a lock-free atomic, and
+// each asset slot is guarded by a seqlock so readers copy a consistent price/time/ring without ever blocking the
+// writer.
+//
+// Layout: BusHeader, then max_assets slots of slot_stride bytes, each a BusSlot followed by ticks_per_asset BusTicks.
+
+constexpr char bus_magic[8]			   = {'T', 'M', 'B', 'U', 'S', '0', '0', '3'};
+constexpr const char* bus_default_name = "/trade_market_bus";
+constexpr size_t bus_id_size		   = 64;
+constexpr uint32_t bus_min_assets	   = 256;
+constexpr uint32_t bus_ticks		   = 512;
+
+static_assert(std::atomic<double>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free, "market bus needs lock-free atomics in shared memory");
+
+struct BusHeader
+{
+	char magic[8];
+	uint32_t max_assets;
+	uint32_t ticks_per_asset;
+	uint64_t slot_stride;
+	std::atomic<uint32_t> asset_count;
+	// Set by the writer when it closes or reopens the segment, so readers reattach at once instead of waiting for it
+	// to go stale.
+	std::atomic<uint32_t> closed;
+	std::atomic<double> updated_at;
+	// Bumped once per published snapshot; MarketBusWatcher only looks at this.
+	std::atomic<uint64_t> version;
+};
+
+struct BusTick
+{
+	std::atomic<double> time;
+	std::atomic<double> price;
+};
+
+struct alignas(64) BusSlot
+{
+	// Written once before the slot is counted in BusHeader::asset_count, never changed afterwards.
+	char id[bus_id_size];
+	std::atomic<uint64_t> sequence;
+	std::atomic<double> price;
+	std::atomic<double> time;
+	std::atomic<uint64_t> head;
+};
+
+inline uint64_t bus_slot_stride(uint32_t ticks_per_asset)
+{
+	const uint64_t raw = sizeof(BusSlot) + static_cast<uint64_t>(ticks_per_asset) * sizeof(BusTick);
+	return (raw + 63) & ~uint64_t(63);
+}
+
+// Slots for a watchlist of the given size, doubled so assets added later still fit without reopening the segment.
+inline uint32_t bus_assets_for(size_t watchlist_size) { return static_cast<uint32_t>(std::max<size_t>(bus_min_assets, watchlist_size * 2)); }
+
+inline size_t bus_segment_size(uint32_t max_assets, uint32_t ticks_per_asset)
+{
+	const uint64_t header = (sizeof(BusHeader) + 63) & ~uint64_t(63);
+	return static_cast<size_t>(header + max_assets * bus_slot_stride(ticks_per_asset));
+}
+
+// Shared mapping of a bus segment; the writer and the reader differ only in how they open it.
+class BusMapping
+{
+  public:
+	BusMapping() = default;
+	BusMapping(const BusMapping&)			 = delete;
+	BusMapping& operator=(const BusMapping&) = delete;
+	~BusMapping() { unmap(); }
+
+	bool map(int fd, size_t size, bool writable)
+	{
+		void* mapped = ::mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+		if (mapped == MAP_FAILED)
+		{
+			return false;
+		}
+		m_data = static_cast<char*>(mapped);
+		m_size = size;
+		return true;
+	}
+
+	void unmap()
+	{
+		if (m_data)
+		{
+			::munmap(m_data, m_size);
+			m_data = nullptr;
+			m_size = 0;
+		}
+	}
+
+	bool mapped() const { return m_data != nullptr; }
+	BusHeader* header() const { return reinterpret_cast<BusHeader*>(m_data); }
+
+	BusSlot* slot(uint32_t index) const
+	{
+		const uint64_t offset = ((sizeof(BusHeader) + 63) & ~uint64_t(63)) + index * header()->slot_stride;
+		return reinterpret_cast<BusSlot*>(m_data + offset);
+	}
+
+	static BusTick* ticks(BusSlot* slot) { return reinterpret_cast<BusTick*>(reinterpret_cast<char*>(slot) + sizeof(BusSlot)); }
+
+  private:
+	char* m_data  = nullptr;
+	size_t m_size = 0;
+};
+
+// Read-only mapping of an existing, fully initialised segment. Fails while the writer has not created it yet.
+bool map_bus_segment(const std::string& name, BusMapping& mapping)
+{
+	int fd = ::shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat info{};
+	bool mapped = ::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(BusHeader) && mapping.map(fd, static_cast<size_t>(info.st_size), false);
+	::close(fd);
+	if (!mapped)
+	{
+		return false;
+	}
+
+	const BusHeader* header = mapping.header();
+	if (std::memcmp(header->magic, bus_magic, sizeof(bus_magic)) != 0 || static_cast<size_t>(info.st_size) < bus_segment_size(header->max_assets, header->ticks_per_asset))
+	{
+		mapping.unmap();
+		return false;
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return true;
+}
+
+// Single writer. Creates a fresh segment on open(); readers attached to a previous one see it marked closed and
+// reattach.
+class MarketBusWriter
+{
+  public:
+	~MarketBusWriter() { close(); }
+
+	bool open(const std::string& name = bus_default_name, uint32_t max_assets = bus_min_assets, uint32_t ticks_per_asset = bus_ticks)
+	{
+		close();
+		::shm_unlink(name.c_str());
+		int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+		if (fd < 0)
+		{
+			std::cerr << "Failed to create market bus " << name << ": " << std::strerror(errno) << "\n";
+			return false;
+		}
+
+		const size_t size = bus_segment_size(max_assets, ticks_per_asset);
+		const bool mapped = ::ftruncate(fd, static_cast<off_t>(size)) == 0 && m_mapping.map(fd, size, true);
+		::close(fd);
+		if (!mapped)
+		{
+			std::cerr << "Failed to map market bus " << name << ": " << std::strerror(errno) << "\n";
+			::shm_unlink(name.c_str());
+			return false;
+		}
+
+		// ftruncate zero-fills, so every atomic already reads 0; only the geometry and the magic need writing.
+		BusHeader* header		= m_mapping.header();
+		header->max_assets		= max_assets;
+		header->ticks_per_asset = ticks_per_asset;
+		header->slot_stride		= bus_slot_stride(ticks_per_asset);
+		std::atomic_thread_fence(std::memory_order_release);
+		std::memcpy(header->magic, bus_magic, sizeof(bus_magic));
+		m_name = name;
+		return true;
+	}
+
+	void close()
+	{
+		if (!m_mapping.mapped())
+		{
+			return;
+		}
+		m_mapping.header()->closed.store(1, std::memory_order_release);
+		m_mapping.unmap();
+		::shm_unlink(m_name.c_str());
+		m_slots.clear();
+		m_dropped.clear();
+	}
+
+	bool is_open() const { return m_mapping.mapped(); }
+	uint32_t max_assets() const { return is_open() ? m_mapping.header()->max_assets : 0; }
+
+	void publish(const PriceSnapshot& snapshot)
+	{
+		if (!is_open())
+		{
+			return;
+		}
+		for (const auto& quote : snapshot.quotes)
+		{
+			publish(quote.id, tick_time(snapshot, quote), quote.price);
+		}
+		m_mapping.header()->version.fetch_add(1, std::memory_order_release);
+		heartbeat();
+	}
+
+	// Tells readers the writer is alive even while polling is backed off and nothing new is published.
+	void heartbeat()
+	{
+		if (is_open())
+		{
+			m_mapping.header()->updated_at.store(g_tick_clock.now(), std::memory_order_release);
+		}
+	}
+
+	// Ticks not newer than the slot's latest one are ignored, mirroring SeriesStore::append.
+	void publish(const std::string& id, double time, double price)
+	{
+		BusSlot* slot = find_or_add(id);
+		if (!slot || time <= slot->time.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		const uint32_t capacity = m_mapping.header()->ticks_per_asset;
+		const uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+		const uint64_t head		= slot->head.load(std::memory_order_relaxed);
+		slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		BusTick& tick = BusMapping::ticks(slot)[head % capacity];
+		tick.time.store(time, std::memory_order_relaxed);
+		tick.price.store(price, std::memory_order_relaxed);
+		slot->price.store(price, std::memory_order_relaxed);
+		slot->time.store(time, std::memory_order_relaxed);
+		slot->head.store(head + 1, std::memory_order_relaxed);
+
+		slot->sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+  private:
+	BusSlot* find_or_add(const std::string& id)
+	{
+		auto it = m_slots.find(id);
+		if (it != m_slots.end())
+		{
+			return it->second;
+		}
+
+		BusHeader* header	 = m_mapping.header();
+		const uint32_t index = header->asset_count.load(std::memory_order_relaxed);
+		if (index >= header->max_assets || id.size() >= bus_id_size)
+		{
+			// Reported once per id; the quote still reaches the writer's own store and journal.
+			if (m_dropped.insert(id).second)
+			{
+				std::cerr << "Market bus cannot carry " << id << ": " << (id.size() >= bus_id_size ? "id too long" : "all slots in use") << "\n";
+			}
+			return nullptr;
+		}
+		BusSlot* slot = m_mapping.slot(index);
+		std::memcpy(slot->id, id.c_str(), id.size() + 1);
+		header->asset_count.store(index + 1, std::memory_order_release);
+		m_slots.emplace(id, slot);
+		return slot;
+	}
+
+	BusMapping m_mapping;
+	std::string m_name;
+	std::unordered_map<std::string, BusSlot*> m_slots;
+	std::unordered_set<std::string> m_dropped;
+};
+
+// Read-only view of the bus. poll() turns everything published since the previous call into one PriceSnapshot whose
+// quotes carry their tick times, so viewers feed it through the same apply path as a network poll.
+class MarketBusReader
+{
+  public:
+	// A segment that has not been updated for this long is assumed abandoned and reopened on the next poll.
+	static constexpr double stale_after = 30.0;
+	// A seqlock still odd after this many reads belongs to a writer that died mid-update; the slot is skipped (and
+	// then retried once per poll) instead of spinning until the segment goes stale.
+	static constexpr int max_read_attempts = 64;
+
+	~MarketBusReader() { close(); }
+
+	bool open(const std::string& name = bus_default_name)
+	{
+		close();
+		m_name = name;
+		if (!map_bus_segment(name, m_mapping))
+		{
+			return false;
+		}
+		m_opened_at = g_tick_clock.now();
+		return true;
+	}
+
+	void close()
+	{
+		m_mapping.unmap();
+		m_slots.clear();
+	}
+
+	bool is_open() const { return m_mapping.mapped(); }
+
+	bool poll(PriceSnapshot& out)
+	{
+		out.quotes.clear();
+		if (!is_open() && (m_name.empty() || !open(m_name)))
+		{
+			return false;
+		}
+
+		BusHeader* header		= m_mapping.header();
+		const double updated_at = header->updated_at.load(std::memory_order_acquire);
+		const double now		= g_tick_clock.now();
+		if (header->closed.load(std::memory_order_acquire) != 0 || now - std::max(updated_at, m_opened_at) > stale_after)
+		{
+			close();
+			return false;
+		}
+
+		const uint32_t count = std::min(header->asset_count.load(std::memory_order_acquire), header->max_assets);
+		m_slots.resize(count);
+		for (uint32_t idx_for_i = 0; idx_for_i < count; ++idx_for_i)
+		{
+			read_slot(m_mapping.slot(idx_for_i), m_slots[idx_for_i], out);
+		}
+		out.timestamp = now;
+		return !out.quotes.empty();
+	}
+
+  private:
+	struct SlotState
+	{
+		double seen = 0.0;
+		bool stuck	= false;
+	};
+
+	void read_slot(BusSlot* slot, SlotState& state, PriceSnapshot& out)
+	{
+		const uint32_t capacity = m_mapping.header()->ticks_per_asset;
+		const int attempts		= state.stuck ? 1 : max_read_attempts;
+		double& seen			= state.seen;
+		for (int attempt = 0; attempt < attempts; ++attempt)
+		{
+			const uint64_t before = slot->sequence.load(std::memory_order_acquire);
+			if (before & 1)
+			{
+				continue;
+			}
+			state.stuck = false;
+			if (slot->time.load(std::memory_order_relaxed) <= seen)
+			{
+				return;
+			}
+
+			m_ticks.clear();
+			const uint64_t head	 = slot->head.load(std::memory_order_relaxed);
+			const uint64_t first = head > capacity ? head - capacity : 0;
+			for (uint64_t index = first; index < head; ++index)
+			{
+				const BusTick& tick = BusMapping::ticks(slot)[index % capacity];
+				const double time	= tick.time.load(std::memory_order_relaxed);
+				if (time > seen)
+				{
+					m_ticks.push_back({time, static_cast<float>(tick.price.load(std::memory_order_relaxed))});
+				}
+			}
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot->sequence.load(std::memory_order_relaxed) != before)
+			{
+				continue;
+			}
+
+			for (const auto& tick : m_ticks)
+			{
+				out.quotes.push_back({slot->id, tick.price, tick.time});
+			}
+			seen = m_ticks.back().time;
+			return;
+		}
+
+		if (!state.stuck)
+		{
+			std::cerr << "Market bus slot " << slot->id << " is stuck mid-update, skipping it\n";
+			state.stuck = true;
+		}
+	}
+
+	struct Tick
+	{
+		double time;
+		float price;
+	};
+
+	BusMapping m_mapping;
+	std::string m_name;
+	double m_opened_at = 0.0;
+	std::vector<SlotState> m_slots;
+	std::vector<Tick> m_ticks;
+};
+
+// Wakes a viewer when the daemon publishes, from its own thread and read-only mapping, so the render loop can sleep
+// until there is something new instead of finding out on its next timed poll. Only the header's version is read.
+class MarketBusWatcher
+{
+  public:
+	explicit MarketBusWatcher(std::chrono::milliseconds interval = std::chrono::milliseconds(50)) : m_interval(interval) {}
+	MarketBusWatcher(const MarketBusWatcher&)			 = delete;
+	MarketBusWatcher& operator=(const MarketBusWatcher&) = delete;
+	~MarketBusWatcher() { stop(); }
+
+	// on_change runs on the watcher thread.
+	void start(const std::string& name, std::function<void()> on_change)
+	{
+		if (m_thread.joinable())
+		{
+			return;
+		}
+		m_name		= name;
+		m_on_change = std::move(on_change);
+		m_stop		= false;
+		m_thread	= std::thread(&MarketBusWatcher::run, this);
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_cv.notify_one();
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+	}
+
+  private:
+	void run()
+	{
+		BusMapping mapping;
+		uint64_t seen	 = 0;
+		double opened_at = 0.0;
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (!m_stop)
+		{
+			lock.unlock();
+			if (!mapping.mapped() && map_bus_segment(m_name, mapping))
+			{
+				seen	  = 0;
+				opened_at = g_tick_clock.now();
+			}
+			if (mapping.mapped())
+			{
+				const BusHeader* header = mapping.header();
+				const double updated_at = std::max(header->updated_at.load(std::memory_order_acquire), opened_at);
+				const bool gone			= header->closed.load(std::memory_order_acquire) != 0 || g_tick_clock.now() - updated_at > MarketBusReader::stale_after;
+				const uint64_t version	= header->version.load(std::memory_order_acquire);
+				if (gone)
+				{
+					// Let the reader notice too, then look for the writer's next segment.
+					mapping.unmap();
+					m_on_change();
+				}
+				else if (version != seen)
+				{
+					seen = version;
+					m_on_change();
+				}
+			}
+			lock.lock();
+			m_cv.wait_for(lock, m_interval, [this] { return m_stop; });
+		}
+	}
+
+	std::chrono::milliseconds m_interval;
+	std::string m_name;
+	std::function<void()> m_on_change;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_stop = false;
+};
+
+#endif // MARKET_BUS_HPP
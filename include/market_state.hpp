@@ -0,0 +1,170 @@
+#ifndef MARKET_STATE_HPP
+#define MARKET_STATE_HPP
+
+#include "asset_registry.hpp"
+#include "coingecko.hpp"
+#include "history_service.hpp"
+#include "indicators.hpp"
+#include "ingest_worker.hpp"
+#include "market_board.hpp"
+#include "series_store.hpp"
+#include "tick_journal.hpp"
+#include "watchlist_persister.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Market-side state shared by the viewer and the headless daemon; nothing here depends on SDL, OpenGL or ImGui.
+std::string g_api_key;
+IngestWorker g_ingest;
+HistoryService g_history;
+WatchlistPersister g_watchlist_persister;
+IndicatorEngine g_indicators;
+
+std::vector<std::string> g_crypto_watchlist;
+AssetRegistry g_assets;
+MarketBoardCell g_market_board;
+MarketBoardWriter g_market_board_writer(g_market_board);
+
+SeriesStore g_price_history;
+TickJournal g_tick_journal;
+
+// Store appends and indicator updates interleave per quote, so their time is summed and recorded once per snapshot.
+void apply_price_snapshot(const PriceSnapshot& snapshot)
+{
+	double history_seconds	 = 0.0;
+	double indicator_seconds = 0.0;
+	g_market_board_writer.begin(snapshot.timestamp);
+	for (const auto& quote : snapshot.quotes)
+	{
+		const AssetId asset = g_assets.intern(quote.id);
+		PricePoint tick{tick_time(snapshot, quote), quote.price};
+		g_market_board_writer.set(asset, quote.price, tick.timestamp);
+
+		const double append_start = profile_now();
+		const bool appended		  = g_price_history.append(asset, tick);
+		const double append_end	  = profile_now();
+		history_seconds += append_end - append_start;
+		if (appended)
+		{
+			g_indicators.update_closed(asset, g_price_history.find_candles(asset)->interval(indicator_interval));
+			indicator_seconds += profile_now() - append_end;
+			g_tick_journal.append(quote.id, tick);
+		}
+	}
+	g_market_board_writer.publish(g_assets);
+	g_profiler.record(ProfileZone::history, history_seconds);
+	g_profiler.record(ProfileZone::indicators, indicator_seconds);
+}
+
+// History built from this process's own store instead of market_chart: hourly closes of the archive over the last
+// `days`. With --bus the viewer's store holds the daemon's journal replayed at startup plus every bus tick since,
+// so viewers never download history themselves.
+HistoryHandle store_history(AssetId asset, int days)
+{
+	auto series				= std::make_shared<HistorySeries>();
+	const CandleSeries bars = g_price_history.archive_candles(asset, candle_intervals[indicator_interval]);
+	const double since		= bars.empty() ? 0.0 : bars.back().time - days * 86400.0;
+	for (size_t idx_for_i = 0; idx_for_i < bars.size(); ++idx_for_i)
+	{
+		if (bars[idx_for_i].time >= since)
+		{
+			series->times.push_back(bars[idx_for_i].time);
+			series->prices.push_back(bars[idx_for_i].close);
+		}
+	}
+	series->ok = series->times.size() > 1;
+	series->lod.build(series->times, series->prices);
+	series->candles.build(series->times, series->prices);
+
+	std::promise<std::shared_ptr<const HistorySeries>> ready;
+	ready.set_value(std::move(series));
+	return ready.get_future().share();
+}
+
+// COINGECKO_API_KEY wins when set, so servers without a gpg agent can run the daemon.
+std::string read_api_key()
+{
+	if (const char* env = std::getenv("COINGECKO_API_KEY"))
+	{
+		if (*env != '\0')
+		{
+			return env;
+		}
+	}
+
+	const char* cmd = "gpg --quiet --batch --yes --decrypt config/apikey.txt.gpg 2>/dev/null";
+	FILE* pipe		= popen(cmd, "r");
+	if (!pipe)
+	{
+		std::cerr << "Failed to run gpg command. \n";
+		return "";
+	}
+
+	std::ostringstream key_stream;
+	char buffer[128];
+	while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+	{
+		key_stream << buffer;
+	}
+	pclose(pipe);
+
+	return key_stream.str();
+}
+
+void load_watchlist(const std::string& path)
+{
+
+	std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+	if (!std::filesystem::exists(path))
+	{
+		std::ofstream create_file(path);
+		if (!create_file)
+		{
+			std::cerr << "Failed to create watchlist file at " << path << "\n";
+			return;
+		}
+		return;
+	}
+
+	std::ifstream file(path);
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		std::transform(line.begin(), line.end(), line.begin(), ::tolower);
+		if (line.empty())
+		{
+			continue;
+		}
+		const AssetId asset = g_assets.intern(line);
+		if (!g_assets.watched(asset))
+		{
+			g_assets.state(asset).watch_slot = g_crypto_watchlist.size();
+			g_crypto_watchlist.push_back(line);
+		}
+	}
+}
+
+// Replaces the current watchlist with the file's contents, e.g. after a viewer saved an edit. Returns the previous
+// list so the caller can tell which assets came and went.
+std::vector<std::string> reload_watchlist(const std::string& path)
+{
+	for (const auto& id : g_crypto_watchlist)
+	{
+		g_assets.state(g_assets.intern(id)).watch_slot = no_watch_slot;
+	}
+	std::vector<std::string> previous = std::move(g_crypto_watchlist);
+	g_crypto_watchlist.clear();
+	load_watchlist(path);
+	return previous;
+}
+
+#endif // MARKET_STATE_HPP
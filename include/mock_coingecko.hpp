@@ -0,0 +1,365 @@
+#ifndef MOCK_COINGECKO_HPP
+#define MOCK_COINGECKO_HPP
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+struct MockConfig
+{
+	uint16_t port	 = 8787;
+	int latency_ms	 = 20;
+	int jitter_ms	 = 10;
+	double error_rate = 0.0;
+	// Share of requests answered with 429 and a Retry-After of retry_after seconds.
+	double throttle_rate = 0.0;
+	int retry_after		 = 1;
+	uint32_t seed		 = 42;
+	// Optional directory of recorded payloads: simple_price.json and <id>.market_chart.json are served verbatim
+	// when present, anything missing falls back to synthetic data.
+	std::string replay_dir;
+};
+
+struct MockStats
+{
+	std::atomic<uint64_t> requests{0};
+	std::atomic<uint64_t> errors{0};
+	std::atomic<uint64_t> throttled{0};
+	std::atomic<uint64_t> not_found{0};
+};
+
+// Deterministic synthetic price for an id at a unix time: a per-id base level with a slow oscillation.
+double mock_price(const std::string& id, double unix_seconds)
+{
+	const uint32_t hash = static_cast<uint32_t>(std::hash<std::string>{}(id));
+	const double base	= 1.0 + static_cast<double>(hash % 100000);
+	return base * (1.0 + 0.02 * std::sin(unix_seconds / 3600.0 + static_cast<double>(hash % 628) / 100.0));
+}
+
+std::string mock_simple_price(const std::string& ids, double now)
+{
+	std::string body = "{";
+	size_t start	 = 0;
+	while (start <= ids.size())
+	{
+		size_t end = ids.find(',', start);
+		if (end == std::string::npos)
+		{
+			end = ids.size();
+		}
+		const std::string id = ids.substr(start, end - start);
+		if (!id.empty())
+		{
+			char entry[128];
+			std::snprintf(entry, sizeof(entry), "\":{\"usd\":%.6f,\"last_updated_at\":%lld}", mock_price(id, now), static_cast<long long>(now));
+			body += (body.size() > 1 ? ",\"" : "\"") + id + entry;
+		}
+		start = end + 1;
+	}
+	return body + "}";
+}
+
+// Same granularity as the live API: 5-minute points for one day, hourly up to 90 days, daily beyond.
+std::string mock_market_chart(const std::string& id, int days, double now)
+{
+	const double step	= days <= 1 ? 300.0 : (days <= 90 ? 3600.0 : 86400.0);
+	const double first	= now - days * 86400.0;
+	std::string body	= "{\"prices\":[";
+	bool first_point	= true;
+	char point[64];
+	for (double t = std::ceil(first / step) * step; t <= now; t += step)
+	{
+		std::snprintf(point, sizeof(point), "%s[%lld,%.6f]", first_point ? "" : ",", static_cast<long long>(t * 1000.0), mock_price(id, t));
+		body += point;
+		first_point = false;
+	}
+	return body + "],\"market_caps\":[],\"total_volumes\":[]}";
+}
+
+std::string mock_query_value(const std::string& query, const std::string& key)
+{
+	size_t at = 0;
+	while (at < query.size())
+	{
+		size_t end = query.find('&', at);
+		if (end == std::string::npos)
+		{
+			end = query.size();
+		}
+		if (query.compare(at, key.size() + 1, key + "=") == 0)
+		{
+			return query.substr(at + key.size() + 1, end - at - key.size() - 1);
+		}
+		at = end + 1;
+	}
+	return "";
+}
+
+// Minimal HTTP/1.1 stand-in for the CoinGecko endpoints the client uses (simple/price and coins/<id>/market_chart)
+// with injectable latency, jitter, 5xx errors and 429s. One thread per keep-alive connection, which is plenty for
+// the request engine's handful of connections.
+class MockCoinGecko
+{
+  public:
+	MockCoinGecko() = default;
+	MockCoinGecko(const MockCoinGecko&)			   = delete;
+	MockCoinGecko& operator=(const MockCoinGecko&) = delete;
+	~MockCoinGecko() { stop(); }
+
+	bool start(const MockConfig& config)
+	{
+		m_config = config;
+		m_listen = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (m_listen < 0)
+		{
+			return false;
+		}
+		int reuse = 1;
+		::setsockopt(m_listen, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+		sockaddr_in address{};
+		address.sin_family		= AF_INET;
+		address.sin_port		= htons(config.port);
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (::bind(m_listen, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(m_listen, 64) != 0)
+		{
+			std::cerr << "mock: cannot listen on port " << config.port << ": " << std::strerror(errno) << "\n";
+			::close(m_listen);
+			m_listen = -1;
+			return false;
+		}
+
+		socklen_t length = sizeof(address);
+		::getsockname(m_listen, reinterpret_cast<sockaddr*>(&address), &length);
+		m_port	 = ntohs(address.sin_port);
+		m_stop	 = false;
+		m_thread = std::thread(&MockCoinGecko::accept_loop, this);
+		return true;
+	}
+
+	void stop()
+	{
+		if (!m_thread.joinable())
+		{
+			return;
+		}
+		m_stop = true;
+		m_thread.join();
+		::close(m_listen);
+		m_listen = -1;
+
+		std::lock_guard<std::mutex> lock(m_connections_mutex);
+		for (auto& connection : m_connections)
+		{
+			connection.thread.join();
+		}
+		m_connections.clear();
+	}
+
+	uint16_t port() const { return m_port; }
+	std::string base_url() const { return "http://127.0.0.1:" + std::to_string(m_port) + "/api/v3"; }
+	const MockStats& stats() const { return m_stats; }
+
+  private:
+	void accept_loop()
+	{
+		uint32_t connection_index = 0;
+		while (!m_stop)
+		{
+			pollfd listen_poll{m_listen, POLLIN, 0};
+			if (::poll(&listen_poll, 1, 100) <= 0)
+			{
+				continue;
+			}
+			int client = ::accept4(m_listen, nullptr, nullptr, SOCK_CLOEXEC);
+			if (client < 0)
+			{
+				continue;
+			}
+			int no_delay = 1;
+			::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+			std::lock_guard<std::mutex> lock(m_connections_mutex);
+			reap_connections();
+			Connection& connection = m_connections.emplace_back();
+			connection.thread	   = std::thread(&MockCoinGecko::serve, this, client, m_config.seed + connection_index++, &connection.done);
+		}
+	}
+
+	// Joins the threads of clients that already hung up, so a long run with short-lived connections stays bounded.
+	// Called with m_connections_mutex held.
+	void reap_connections()
+	{
+		for (auto it = m_connections.begin(); it != m_connections.end();)
+		{
+			if (it->done.load())
+			{
+				it->thread.join();
+				it = m_connections.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	void serve(int client, uint32_t seed, std::atomic<bool>* done)
+	{
+		std::mt19937 random(seed);
+		std::string buffer;
+		char chunk[4096];
+		while (!m_stop)
+		{
+			size_t header_end = buffer.find("\r\n\r\n");
+			if (header_end == std::string::npos)
+			{
+				pollfd client_poll{client, POLLIN, 0};
+				if (::poll(&client_poll, 1, 100) <= 0)
+				{
+					continue;
+				}
+				ssize_t received = ::recv(client, chunk, sizeof(chunk), 0);
+				if (received <= 0)
+				{
+					break;
+				}
+				buffer.append(chunk, static_cast<size_t>(received));
+				continue;
+			}
+
+			const std::string request = buffer.substr(0, header_end);
+			buffer.erase(0, header_end + 4);
+			if (!respond(client, request, random))
+			{
+				break;
+			}
+		}
+		::close(client);
+		*done = true;
+	}
+
+	bool respond(int client, const std::string& request, std::mt19937& random)
+	{
+		++m_stats.requests;
+
+		std::istringstream line(request.substr(0, request.find("\r\n")));
+		std::string method;
+		std::string target;
+		line >> method >> target;
+
+		const int jitter = m_config.jitter_ms > 0 ? std::uniform_int_distribution<int>(-m_config.jitter_ms, m_config.jitter_ms)(random) : 0;
+		const int delay	 = std::max(0, m_config.latency_ms + jitter);
+		std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+
+		std::uniform_real_distribution<double> chance(0.0, 1.0);
+		if (m_config.throttle_rate > 0.0 && chance(random) < m_config.throttle_rate)
+		{
+			++m_stats.throttled;
+			return send(client, 429, "{\"status\":{\"error_code\":429,\"error_message\":\"throttled\"}}", "Retry-After: " + std::to_string(m_config.retry_after) + "\r\n");
+		}
+		if (m_config.error_rate > 0.0 && chance(random) < m_config.error_rate)
+		{
+			++m_stats.errors;
+			return send(client, 500, "{\"error\":\"injected\"}");
+		}
+
+		const size_t query_at	 = target.find('?');
+		const std::string path	 = target.substr(0, query_at);
+		const std::string query	 = query_at == std::string::npos ? "" : target.substr(query_at + 1);
+		const double now		 = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+		const std::string prefix = "/api/v3/coins/";
+		const std::string suffix = "/market_chart";
+
+		if (method == "GET" && path == "/api/v3/simple/price")
+		{
+			std::string recorded;
+			return send(client, 200, load_recorded("simple_price.json", recorded) ? recorded : mock_simple_price(mock_query_value(query, "ids"), now));
+		}
+		if (method == "GET" && path.size() > prefix.size() + suffix.size() && path.compare(0, prefix.size(), prefix) == 0 &&
+			path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0)
+		{
+			const std::string id = path.substr(prefix.size(), path.size() - prefix.size() - suffix.size());
+			const int days		 = std::max(1, std::atoi(mock_query_value(query, "days").c_str()));
+			std::string recorded;
+			return send(client, 200, load_recorded(id + ".market_chart.json", recorded) ? recorded : mock_market_chart(id, days, now));
+		}
+
+		++m_stats.not_found;
+		return send(client, 404, "{\"error\":\"not found\"}");
+	}
+
+	bool load_recorded(const std::string& name, std::string& out) const
+	{
+		if (m_config.replay_dir.empty())
+		{
+			return false;
+		}
+		std::ifstream file(m_config.replay_dir + "/" + name, std::ios::binary);
+		if (!file)
+		{
+			return false;
+		}
+		std::ostringstream contents;
+		contents << file.rdbuf();
+		out = contents.str();
+		return true;
+	}
+
+	static bool send(int client, int status, const std::string& body, const std::string& extra_headers = "")
+	{
+		const char* reason = status == 200 ? "OK" : (status == 404 ? "Not Found" : (status == 429 ? "Too Many Requests" : "Internal Server Error"));
+		std::string response = "HTTP/1.1 " + std::to_string(status) + " " + reason + "\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) +
+							   "\r\n" + extra_headers + "\r\n" + body;
+		size_t sent = 0;
+		while (sent < response.size())
+		{
+			ssize_t written = ::send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+			if (written <= 0)
+			{
+				return false;
+			}
+			sent += static_cast<size_t>(written);
+		}
+		return true;
+	}
+
+	MockConfig m_config;
+	MockStats m_stats;
+	int m_listen	= -1;
+	uint16_t m_port = 0;
+	std::atomic<bool> m_stop{false};
+	std::thread m_thread;
+
+	// A list, so each thread's done flag keeps its address while other entries are reaped.
+	struct Connection
+	{
+		std::thread thread;
+		std::atomic<bool> done{false};
+	};
+
+	std::mutex m_connections_mutex;
+	std::list<Connection> m_connections;
+};
+
+#endif // MOCK_COINGECKO_HPP
@@ -0,0 +1,196 @@
+#ifndef POLL_SCHEDULER_HPP
+#define POLL_SCHEDULER_HPP
+
+#include "coingecko.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+using PollClock = std::chrono::steady_clock;
+
+struct PollPolicy
+{
+	// Demo plan defaults: 30 calls per minute with a small burst allowance.
+	double calls_per_minute = 30.0;
+	double burst			= 5.0;
+
+	std::chrono::milliseconds watchlist_interval = std::chrono::seconds(5);
+	std::chrono::milliseconds focus_interval	 = std::chrono::seconds(2);
+	std::chrono::milliseconds max_backoff		 = std::chrono::minutes(5);
+
+	// Replies slower than this stretch both intervals; fast ones shrink them back.
+	double slow_reply  = 2.0;
+	double max_stretch = 8.0;
+};
+
+// Classic token bucket. take() may leave the bucket in debt when a single poll costs more than the burst, so the
+// long-run rate still matches the plan.
+class TokenBucket
+{
+  public:
+	TokenBucket(double per_second, double capacity) : m_per_second(per_second), m_capacity(capacity), m_tokens(capacity) {}
+
+	bool take(PollClock::time_point now, double cost)
+	{
+		refill(now);
+		if (m_tokens < std::min(cost, m_capacity))
+		{
+			return false;
+		}
+		m_tokens -= cost;
+		return true;
+	}
+
+	PollClock::duration wait_for(PollClock::time_point now, double cost)
+	{
+		refill(now);
+		const double missing = std::min(cost, m_capacity) - m_tokens;
+		if (missing <= 0.0 || m_per_second <= 0.0)
+		{
+			return PollClock::duration::zero();
+		}
+		return std::chrono::duration_cast<PollClock::duration>(std::chrono::duration<double>(missing / m_per_second));
+	}
+
+	void drain() { m_tokens = std::min(m_tokens, 0.0); }
+
+  private:
+	void refill(PollClock::time_point now)
+	{
+		if (m_last != PollClock::time_point())
+		{
+			const double elapsed = std::chrono::duration<double>(now - m_last).count();
+			m_tokens			 = std::min(m_capacity, m_tokens + elapsed * m_per_second);
+		}
+		m_last = now;
+	}
+
+	double m_per_second;
+	double m_capacity;
+	double m_tokens;
+	PollClock::time_point m_last;
+};
+
+enum class PollKind
+{
+	none,
+	watchlist,
+	focus,
+	history
+};
+
+// Decides when the ingest thread polls and what. The whole watchlist is refreshed on one cadence and the focused
+// asset on a faster one, both paid for from a shared token bucket (one token per HTTP request). Queued history
+// downloads spend from the same bucket, one at a time, after a due watchlist poll and ahead of the focus poll. HTTP
+// 429 blocks all polling for Retry-After, or an exponential backoff when the header is missing; other failures back
+// off the cadence the same way, and slow replies stretch it.
+class PollScheduler
+{
+  public:
+	explicit PollScheduler(PollPolicy policy = {}) : m_policy(policy), m_budget(policy.calls_per_minute / 60.0, policy.burst) {}
+
+	// watchlist_cost and focus_cost are the number of requests each poll would issue; a focus_cost of 0 means no
+	// asset is focused. history_queued is the number of history downloads waiting for a token. When nothing is due,
+	// wake is set to the next time worth checking.
+	PollKind next(PollClock::time_point now, size_t watchlist_cost, size_t focus_cost, size_t history_queued, PollClock::time_point& wake)
+	{
+		if (now < m_blocked_until)
+		{
+			wake = m_blocked_until;
+			return PollKind::none;
+		}
+
+		if (watchlist_cost > 0 && now >= m_next_watchlist)
+		{
+			return claim(now, PollKind::watchlist, watchlist_cost, wake);
+		}
+		if (history_queued > 0)
+		{
+			return claim(now, PollKind::history, 1, wake);
+		}
+		if (focus_cost > 0 && now >= m_next_focus)
+		{
+			return claim(now, PollKind::focus, focus_cost, wake);
+		}
+
+		wake = watchlist_cost > 0 ? m_next_watchlist : now + m_policy.watchlist_interval;
+		if (focus_cost > 0)
+		{
+			wake = std::min(wake, m_next_focus);
+		}
+		return PollKind::none;
+	}
+
+	void record(PollClock::time_point now, PollKind kind, const FetchReport& report)
+	{
+		if (report.slowest_reply > m_policy.slow_reply)
+		{
+			m_stretch = std::min(m_stretch * 1.5, m_policy.max_stretch);
+		}
+		else
+		{
+			m_stretch = std::max(m_stretch * 0.8, 1.0);
+		}
+
+		const bool failed = report.requests > 0 && report.failed == report.requests;
+		if (report.throttled > 0 || failed)
+		{
+			++m_failures;
+		}
+		else
+		{
+			m_failures = 0;
+		}
+
+		if (report.throttled > 0)
+		{
+			m_budget.drain();
+			m_blocked_until = now + (report.retry_after > 0.0 ? seconds(report.retry_after) : backoff(m_policy.watchlist_interval));
+		}
+
+		const PollClock::duration focus_delay = failed ? backoff(m_policy.focus_interval) : stretched(m_policy.focus_interval);
+		m_next_focus						  = now + focus_delay;
+		if (kind == PollKind::watchlist)
+		{
+			m_next_watchlist = now + (failed ? backoff(m_policy.watchlist_interval) : stretched(m_policy.watchlist_interval));
+		}
+	}
+
+	// The watchlist changed: refresh it as soon as the budget allows.
+	void watchlist_changed() { m_next_watchlist = PollClock::time_point(); }
+
+	void focus_changed() { m_next_focus = PollClock::time_point(); }
+
+  private:
+	static PollClock::duration seconds(double value) { return std::chrono::duration_cast<PollClock::duration>(std::chrono::duration<double>(value)); }
+
+	PollKind claim(PollClock::time_point now, PollKind kind, size_t cost, PollClock::time_point& wake)
+	{
+		if (m_budget.take(now, static_cast<double>(cost)))
+		{
+			return kind;
+		}
+		wake = now + m_budget.wait_for(now, static_cast<double>(cost));
+		return PollKind::none;
+	}
+
+	PollClock::duration stretched(std::chrono::milliseconds interval) const { return seconds(std::chrono::duration<double>(interval).count() * m_stretch); }
+
+	PollClock::duration backoff(std::chrono::milliseconds interval) const
+	{
+		const double factor = static_cast<double>(1u << std::min(m_failures, 10u));
+		const double delay	= std::min(std::chrono::duration<double>(interval).count() * factor, std::chrono::duration<double>(m_policy.max_backoff).count());
+		return seconds(delay);
+	}
+
+	PollPolicy m_policy;
+	TokenBucket m_budget;
+	PollClock::time_point m_next_watchlist;
+	PollClock::time_point m_next_focus;
+	PollClock::time_point m_blocked_until;
+	unsigned m_failures = 0;
+	double m_stretch	= 1.0;
+};
+
+#endif // POLL_SCHEDULER_HPP
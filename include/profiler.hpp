@@ -0,0 +1,185 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+enum class ProfileZone : uint8_t
+{
+	frame,
+	render,
+	fetch,
+	parse,
+	history,
+	indicators,
+	seed,
+	count
+};
+
+constexpr size_t profile_zone_count = static_cast<size_t>(ProfileZone::count);
+
+constexpr std::array<const char*, profile_zone_count> profile_zone_names = {"frame", "render", "fetch", "parse", "history", "indicators", "seed"};
+
+double profile_now() { return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+struct ProfileStats
+{
+	uint64_t count = 0;
+	double last_ms = 0.0;
+	double mean_ms = 0.0;
+	double p50_ms  = 0.0;
+	double p99_ms  = 0.0;
+	double max_ms  = 0.0;
+};
+
+// Ring of the most recent durations of one zone, in milliseconds. Any thread may record; a reader copying the window
+// while it is written can see a mix of old and new samples, which is fine for percentiles.
+class ZoneSamples
+{
+  public:
+	static constexpr size_t window = 1024;
+
+	void record(float ms)
+	{
+		const uint64_t index = m_count.fetch_add(1, std::memory_order_relaxed);
+		m_samples[index % window].store(ms, std::memory_order_relaxed);
+	}
+
+	uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+	// Oldest first.
+	void copy(std::vector<float>& out) const
+	{
+		const uint64_t count = this->count();
+		const uint64_t first = count > window ? count - window : 0;
+		out.clear();
+		for (uint64_t index = first; index < count; ++index)
+		{
+			out.push_back(m_samples[index % window].load(std::memory_order_relaxed));
+		}
+	}
+
+  private:
+	std::array<std::atomic<float>, window> m_samples{};
+	std::atomic<uint64_t> m_count{0};
+};
+
+// Always-on latency profiler: scoped zones record wall time per call into fixed rings, and readers derive rolling
+// percentiles over the last ZoneSamples::window calls. Recording never allocates or locks.
+class Profiler
+{
+  public:
+	void record(ProfileZone zone, double seconds) { m_zones[static_cast<size_t>(zone)].record(static_cast<float>(seconds * 1000.0)); }
+
+	void samples(ProfileZone zone, std::vector<float>& out) const { m_zones[static_cast<size_t>(zone)].copy(out); }
+
+	// scratch is reused between calls so a per-frame overlay does not allocate.
+	ProfileStats stats(ProfileZone zone, std::vector<float>& scratch) const
+	{
+		ProfileStats stats;
+		stats.count = m_zones[static_cast<size_t>(zone)].count();
+		samples(zone, scratch);
+		if (scratch.empty())
+		{
+			return stats;
+		}
+
+		stats.last_ms = scratch.back();
+		double total  = 0.0;
+		for (float sample : scratch)
+		{
+			total += sample;
+		}
+		stats.mean_ms = total / static_cast<double>(scratch.size());
+
+		std::sort(scratch.begin(), scratch.end());
+		stats.p50_ms = scratch[(scratch.size() - 1) / 2];
+		stats.p99_ms = scratch[(scratch.size() - 1) * 99 / 100];
+		stats.max_ms = scratch.back();
+		return stats;
+	}
+
+	void write_json(std::ostream& out, double timestamp) const
+	{
+		std::vector<float> scratch;
+		char line[256];
+		std::snprintf(line, sizeof(line), "{\"timestamp\":%.3f,\"window\":%zu,\"zones\":[", timestamp, ZoneSamples::window);
+		out << line;
+		for (size_t idx_for_i = 0; idx_for_i < profile_zone_count; ++idx_for_i)
+		{
+			const ProfileStats stats = this->stats(static_cast<ProfileZone>(idx_for_i), scratch);
+			std::snprintf(line, sizeof(line), "%s{\"zone\":\"%s\",\"count\":%llu,\"last_ms\":%.4f,\"mean_ms\":%.4f,\"p50_ms\":%.4f,\"p99_ms\":%.4f,\"max_ms\":%.4f}",
+						  idx_for_i ? "," : "", profile_zone_names[idx_for_i], static_cast<unsigned long long>(stats.count), stats.last_ms, stats.mean_ms, stats.p50_ms,
+						  stats.p99_ms, stats.max_ms);
+			out << line;
+		}
+		out << "]}\n";
+	}
+
+	// Written to a temporary file and renamed, so a scraper never reads a half-written dump. Missing parent
+	// directories are created; any failure is reported and returns false.
+	bool dump(const std::string& path, double timestamp) const
+	{
+		const std::string tmp_path = path + ".tmp";
+		std::error_code ec;
+		const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+		if (!parent.empty() && !std::filesystem::create_directories(parent, ec) && ec)
+		{
+			std::cerr << "Failed to create " << parent << ": " << ec.message() << "\n";
+			return false;
+		}
+
+		{
+			std::ofstream file(tmp_path, std::ios::trunc);
+			if (!file)
+			{
+				std::cerr << "Failed to write profile to " << tmp_path << "\n";
+				return false;
+			}
+			write_json(file, timestamp);
+			if (!file.flush())
+			{
+				std::cerr << "Failed to write profile to " << tmp_path << "\n";
+				return false;
+			}
+		}
+
+		std::filesystem::rename(tmp_path, path, ec);
+		if (ec)
+		{
+			std::cerr << "Failed to replace " << path << ": " << ec.message() << "\n";
+			return false;
+		}
+		return true;
+	}
+
+  private:
+	std::array<ZoneSamples, profile_zone_count> m_zones;
+};
+
+Profiler g_profiler;
+
+class ProfileScope
+{
+  public:
+	explicit ProfileScope(ProfileZone zone, Profiler& profiler = g_profiler) : m_profiler(profiler), m_zone(zone), m_start(profile_now()) {}
+	ProfileScope(const ProfileScope&)			 = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+	~ProfileScope() { m_profiler.record(m_zone, profile_now() - m_start); }
+
+  private:
+	Profiler& m_profiler;
+	ProfileZone m_zone;
+	double m_start;
+};
+
+#endif // PROFILER_HPP
@@ -0,0 +1,123 @@
+#ifndef RCU_HPP
+#define RCU_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Read-copy-update cell with epoch-based reclamation. One writer publishes immutable values; any number of threads
+// read the latest one without locks. A reader announces the epoch it started in by claiming one of max_readers
+// slots, and a retired value is freed only once no reader announced an older epoch, so a ReadGuard's pointer stays
+// valid for the guard's lifetime even if newer values are published meanwhile.
+template <typename T, size_t MaxReaders = 16>
+class RcuCell
+{
+  public:
+	class ReadGuard
+	{
+	  public:
+		ReadGuard(const ReadGuard&)			   = delete;
+		ReadGuard& operator=(const ReadGuard&) = delete;
+		ReadGuard(ReadGuard&& other) noexcept : m_slot(std::exchange(other.m_slot, nullptr)), m_value(other.m_value) {}
+		~ReadGuard()
+		{
+			if (m_slot)
+			{
+				m_slot->store(0, std::memory_order_release);
+			}
+		}
+
+		const T* get() const { return m_value; }
+		const T* operator->() const { return m_value; }
+		const T& operator*() const { return *m_value; }
+		explicit operator bool() const { return m_value != nullptr; }
+
+	  private:
+		friend class RcuCell;
+		ReadGuard(std::atomic<uint64_t>* slot, const T* value) : m_slot(slot), m_value(value) {}
+
+		std::atomic<uint64_t>* m_slot;
+		const T* m_value;
+	};
+
+	RcuCell() = default;
+	RcuCell(const RcuCell&)			   = delete;
+	RcuCell& operator=(const RcuCell&) = delete;
+	~RcuCell() { delete m_current.load(std::memory_order_relaxed); }
+
+	// Any thread. Lock-free: claiming a slot only retries when all MaxReaders slots are held at once.
+	ReadGuard read() const
+	{
+		while (true)
+		{
+			const uint64_t epoch = m_epoch.load(std::memory_order_seq_cst);
+			for (auto& slot : m_slots)
+			{
+				uint64_t idle = 0;
+				if (slot.value.compare_exchange_strong(idle, epoch, std::memory_order_seq_cst))
+				{
+					return ReadGuard(&slot.value, m_current.load(std::memory_order_seq_cst));
+				}
+			}
+		}
+	}
+
+	// Writer thread only. Takes ownership of value; the previous one is freed once every reader that could see it
+	// has released its guard.
+	void publish(std::unique_ptr<const T> value)
+	{
+		const T* previous	 = m_current.exchange(value.release(), std::memory_order_seq_cst);
+		const uint64_t epoch = m_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+		if (previous)
+		{
+			m_retired.emplace_back(epoch, std::unique_ptr<const T>(previous));
+		}
+		reclaim();
+	}
+
+	// Writer thread only; the writer never races itself, so it may look at the current value without a guard.
+	const T* current() const { return m_current.load(std::memory_order_relaxed); }
+
+	uint64_t version() const { return m_epoch.load(std::memory_order_acquire); }
+
+  private:
+	struct alignas(64) Slot
+	{
+		std::atomic<uint64_t> value{0};
+	};
+
+	void reclaim()
+	{
+		uint64_t oldest = UINT64_MAX;
+		for (const auto& slot : m_slots)
+		{
+			const uint64_t epoch = slot.value.load(std::memory_order_seq_cst);
+			if (epoch != 0 && epoch < oldest)
+			{
+				oldest = epoch;
+			}
+		}
+
+		size_t kept = 0;
+		for (auto& retired : m_retired)
+		{
+			if (retired.first > oldest)
+			{
+				m_retired[kept++] = std::move(retired);
+			}
+		}
+		m_retired.resize(kept);
+	}
+
+	// Epoch 0 marks an idle slot, so counting starts at 1.
+	std::atomic<uint64_t> m_epoch{1};
+	std::atomic<const T*> m_current{nullptr};
+	mutable std::array<Slot, MaxReaders> m_slots;
+	std::vector<std::pair<uint64_t, std::unique_ptr<const T>>> m_retired;
+};
+
+#endif // RCU_HPP
@@ -0,0 +1,337 @@
+#ifndef REQUEST_ENGINE_HPP
+#define REQUEST_ENGINE_HPP
+
+#include "curl_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <curl/curl.h>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct HttpRequest
+{
+	std::string url;
+	std::vector<std::string> headers;
+	long timeout_ms = 10000;
+	// When set, the body is streamed through this callback on the engine thread instead of being buffered into
+	// HttpResponse::body. Returning false aborts the transfer.
+	std::function<bool(const char*, size_t)> on_data;
+};
+
+struct HttpResponse
+{
+	CURLcode result = CURLE_OK;
+	long status		= 0;
+	std::string body;
+	double elapsed = 0.0;
+	// Headers of the final response (redirect hops are discarded), names lower-cased.
+	std::vector<std::pair<std::string, std::string>> headers;
+
+	bool ok() const { return result == CURLE_OK && status >= 200 && status < 300; }
+
+	const std::string* header(const std::string& name) const
+	{
+		for (const auto& entry : headers)
+		{
+			if (entry.first == name)
+			{
+				return &entry.second;
+			}
+		}
+		return nullptr;
+	}
+};
+
+using HttpCallback = std::function<void(HttpResponse&&)>;
+
+// Event loop over curl_multi running on its own thread. Requests are queued by any thread and at most max_in_flight
+// transfers are active at once; completion callbacks run on the engine thread and must not block.
+class RequestEngine
+{
+  public:
+	explicit RequestEngine(size_t max_in_flight = 16, CurlPool& pool = g_curl_pool) : m_max_in_flight(max_in_flight), m_pool(pool) {}
+	RequestEngine(const RequestEngine&)			   = delete;
+	RequestEngine& operator=(const RequestEngine&) = delete;
+	~RequestEngine() { stop(); }
+
+	void start()
+	{
+		if (m_thread.joinable())
+		{
+			return;
+		}
+		std::lock_guard<std::mutex> lock(m_queue_mutex);
+		m_multi = curl_multi_init();
+		curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+		m_stop	 = false;
+		m_thread = std::thread(&RequestEngine::run, this);
+	}
+
+	void stop()
+	{
+		if (!m_thread.joinable())
+		{
+			return;
+		}
+		{
+			// Under the queue lock, so a racing submit() either lands before run() drains the queue or fails at once.
+			std::lock_guard<std::mutex> lock(m_queue_mutex);
+			m_stop = true;
+			curl_multi_wakeup(m_multi);
+		}
+		m_thread.join();
+
+		std::lock_guard<std::mutex> lock(m_queue_mutex);
+		curl_multi_cleanup(m_multi);
+		m_multi = nullptr;
+	}
+
+	// Any thread; the engine thread applies the new limit to both the queue and curl's connection cap on its next pass.
+	void set_max_in_flight(size_t max_in_flight)
+	{
+		m_max_in_flight = max_in_flight > 0 ? max_in_flight : 1;
+		wake();
+	}
+
+	void submit(HttpRequest request, HttpCallback callback)
+	{
+		auto transfer	   = std::make_unique<Transfer>();
+		transfer->request  = std::move(request);
+		transfer->callback = std::move(callback);
+		transfer->started  = std::chrono::steady_clock::now();
+
+		std::unique_lock<std::mutex> lock(m_queue_mutex);
+		if (!m_multi || m_stop)
+		{
+			lock.unlock();
+			transfer->response.result = CURLE_ABORTED_BY_CALLBACK;
+			finish(std::move(transfer));
+			return;
+		}
+		m_queue.push_back(std::move(transfer));
+		curl_multi_wakeup(m_multi);
+	}
+
+	std::future<HttpResponse> submit(HttpRequest request)
+	{
+		auto promise = std::make_shared<std::promise<HttpResponse>>();
+		auto future	 = promise->get_future();
+		submit(std::move(request), [promise](HttpResponse&& response) { promise->set_value(std::move(response)); });
+		return future;
+	}
+
+  private:
+	struct Transfer
+	{
+		HttpRequest request;
+		HttpCallback callback;
+		HttpResponse response;
+		CURL* curl				   = nullptr;
+		struct curl_slist* headers = nullptr;
+		std::chrono::steady_clock::time_point started;
+	};
+
+	static size_t write_body(void* contents, size_t size, size_t nmemb, void* userp)
+	{
+		auto* transfer = static_cast<Transfer*>(userp);
+		if (transfer->request.on_data)
+		{
+			return transfer->request.on_data(static_cast<const char*>(contents), size * nmemb) ? size * nmemb : 0;
+		}
+		transfer->response.body.append(static_cast<char*>(contents), size * nmemb);
+		return size * nmemb;
+	}
+
+	static size_t write_header(char* buffer, size_t size, size_t nitems, void* userp)
+	{
+		auto* transfer		= static_cast<Transfer*>(userp);
+		const size_t length = size * nitems;
+		std::string line(buffer, length);
+		while (!line.empty() && (line.back() == '\r' || line.back() == '\n'))
+		{
+			line.pop_back();
+		}
+
+		// A status line starts a new response, e.g. after a redirect or a 100 Continue.
+		if (line.compare(0, 5, "HTTP/") == 0)
+		{
+			transfer->response.headers.clear();
+			return length;
+		}
+
+		const size_t colon = line.find(':');
+		if (colon == std::string::npos)
+		{
+			return length;
+		}
+		std::string name = line.substr(0, colon);
+		std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		size_t value = colon + 1;
+		while (value < line.size() && (line[value] == ' ' || line[value] == '\t'))
+		{
+			++value;
+		}
+		transfer->response.headers.emplace_back(std::move(name), line.substr(value));
+		return length;
+	}
+
+	void wake()
+	{
+		std::lock_guard<std::mutex> lock(m_queue_mutex);
+		if (m_multi)
+		{
+			curl_multi_wakeup(m_multi);
+		}
+	}
+
+	bool activate(std::unique_ptr<Transfer>& transfer)
+	{
+		transfer->curl = m_pool.acquire();
+		if (!transfer->curl)
+		{
+			transfer->response.result = CURLE_FAILED_INIT;
+			return false;
+		}
+
+		CURL* curl = transfer->curl;
+		for (const auto& header : transfer->request.headers)
+		{
+			transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+		}
+		curl_easy_setopt(curl, CURLOPT_URL, transfer->request.url.c_str());
+		curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer->headers);
+		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_body);
+		curl_easy_setopt(curl, CURLOPT_WRITEDATA, transfer.get());
+		curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, write_header);
+		curl_easy_setopt(curl, CURLOPT_HEADERDATA, transfer.get());
+		curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, transfer->request.timeout_ms);
+		curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer.get());
+		transfer->started = std::chrono::steady_clock::now();
+
+		if (curl_multi_add_handle(m_multi, curl) != CURLM_OK)
+		{
+			transfer->response.result = CURLE_FAILED_INIT;
+			return false;
+		}
+		return true;
+	}
+
+	void finish(std::unique_ptr<Transfer> transfer)
+	{
+		if (transfer->curl)
+		{
+			curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &transfer->response.status);
+			curl_multi_remove_handle(m_multi, transfer->curl);
+			m_pool.release(transfer->curl);
+		}
+		curl_slist_free_all(transfer->headers);
+		transfer->response.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - transfer->started).count();
+		if (transfer->callback)
+		{
+			transfer->callback(std::move(transfer->response));
+		}
+	}
+
+	void run()
+	{
+		std::vector<std::unique_ptr<Transfer>> active;
+		size_t connection_limit = 0;
+
+		while (!m_stop)
+		{
+			const size_t max_in_flight = m_max_in_flight;
+			if (max_in_flight != connection_limit)
+			{
+				connection_limit = max_in_flight;
+				curl_multi_setopt(m_multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(connection_limit));
+			}
+			{
+				std::unique_lock<std::mutex> lock(m_queue_mutex);
+				while (!m_queue.empty() && active.size() < max_in_flight)
+				{
+					std::unique_ptr<Transfer> transfer = std::move(m_queue.front());
+					m_queue.pop_front();
+					lock.unlock();
+					if (activate(transfer))
+					{
+						active.push_back(std::move(transfer));
+					}
+					else
+					{
+						finish(std::move(transfer));
+					}
+					lock.lock();
+				}
+			}
+
+			int running = 0;
+			curl_multi_perform(m_multi, &running);
+
+			int pending = 0;
+			while (CURLMsg* msg = curl_multi_info_read(m_multi, &pending))
+			{
+				if (msg->msg != CURLMSG_DONE)
+				{
+					continue;
+				}
+				Transfer* done = nullptr;
+				curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &done);
+				done->response.result = msg->data.result;
+
+				for (auto it = active.begin(); it != active.end(); ++it)
+				{
+					if (it->get() == done)
+					{
+						std::unique_ptr<Transfer> transfer = std::move(*it);
+						*it								   = std::move(active.back());
+						active.pop_back();
+						finish(std::move(transfer));
+						break;
+					}
+				}
+			}
+
+			curl_multi_poll(m_multi, nullptr, 0, 1000, nullptr);
+		}
+
+		for (auto& transfer : active)
+		{
+			transfer->response.result = CURLE_ABORTED_BY_CALLBACK;
+			finish(std::move(transfer));
+		}
+
+		std::deque<std::unique_ptr<Transfer>> queued;
+		{
+			std::lock_guard<std::mutex> lock(m_queue_mutex);
+			queued.swap(m_queue);
+		}
+		for (auto& transfer : queued)
+		{
+			transfer->response.result = CURLE_ABORTED_BY_CALLBACK;
+			finish(std::move(transfer));
+		}
+	}
+
+	std::atomic<size_t> m_max_in_flight;
+	CurlPool& m_pool;
+	CURLM* m_multi = nullptr;
+	std::thread m_thread;
+	std::atomic<bool> m_stop{false};
+
+	std::mutex m_queue_mutex;
+	std::deque<std::unique_ptr<Transfer>> m_queue;
+};
+
+RequestEngine g_request_engine;
+
+#endif // REQUEST_ENGINE_HPP
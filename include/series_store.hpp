@@ -0,0 +1,220 @@
+#ifndef SERIES_STORE_HPP
+#define SERIES_STORE_HPP
+
+#include "asset_registry.hpp"
+#include "candles.hpp"
+#include "gorilla.hpp"
+#include "lod.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+struct PricePoint
+{
+	double timestamp;
+	float price;
+};
+
+// Bounded ring buffer of ticks stored as two contiguous columns. The columns grow on demand up to capacity, so an
+// asset that rarely ticks does not pay for a full ring; once full, the oldest sample lives at offset(). ImPlot
+// consumes the raw columns directly through its offset argument, so no per-frame copy is needed.
+class TimeSeries
+{
+  public:
+	explicit TimeSeries(size_t capacity = 12096) : m_capacity(capacity) {}
+
+	void push(const PricePoint& point)
+	{
+		if (m_size < m_capacity)
+		{
+			// Not wrapped yet, so the next slot is always the end of the columns. Growth is capped at capacity
+			// instead of doubling past it.
+			if (m_timestamps.size() == m_timestamps.capacity())
+			{
+				const size_t grown = std::min(m_capacity, std::max<size_t>(64, m_size * 2));
+				m_timestamps.reserve(grown);
+				m_prices.reserve(grown);
+			}
+			m_timestamps.push_back(point.timestamp);
+			m_prices.push_back(point.price);
+			++m_size;
+			return;
+		}
+
+		m_timestamps[m_head] = point.timestamp;
+		m_prices[m_head]	 = point.price;
+		if (++m_head == m_capacity)
+		{
+			m_head = 0;
+		}
+	}
+
+	size_t size() const { return m_size; }
+	size_t capacity() const { return m_capacity; }
+	bool empty() const { return m_size == 0; }
+
+	// Raw columns in storage order; logical element i is at (offset() + i) % size().
+	const double* timestamps() const { return m_timestamps.data(); }
+	const double* prices() const { return m_prices.data(); }
+	size_t offset() const { return m_head; }
+
+	double timestamp(size_t index) const { return m_timestamps[physical(index)]; }
+	double price(size_t index) const { return m_prices[physical(index)]; }
+	PricePoint back() const { return {timestamp(m_size - 1), static_cast<float>(price(m_size - 1))}; }
+
+	// Calls fn(timestamps, prices, count) for the at most two contiguous runs, oldest first.
+	template <typename Fn>
+	void for_each_run(Fn&& fn) const
+	{
+		const size_t first = m_size < capacity() - m_head ? m_size : capacity() - m_head;
+		if (first > 0)
+		{
+			fn(m_timestamps.data() + m_head, m_prices.data() + m_head, first);
+		}
+		if (m_size > first)
+		{
+			fn(m_timestamps.data(), m_prices.data(), m_size - first);
+		}
+	}
+
+  private:
+	size_t physical(size_t index) const
+	{
+		size_t slot = m_head + index;
+		return slot >= capacity() ? slot - capacity() : slot;
+	}
+
+	size_t m_capacity;
+	std::vector<double> m_timestamps;
+	std::vector<double> m_prices;
+	size_t m_head = 0;
+	size_t m_size = 0;
+};
+
+// Everything kept per asset, allocated on the first tick so pointers stay valid while the slot table grows.
+struct AssetSeries
+{
+	explicit AssetSeries(size_t capacity) : recent(capacity), lod(capacity) {}
+
+	TimeSeries recent;
+	CompressedSeries archive;
+	LodPyramid lod;
+	CandleSet candles;
+};
+
+// Per-asset series indexed by AssetId, so every lookup is an array index.
+class SeriesStore
+{
+  public:
+	explicit SeriesStore(size_t capacity = 12096) : m_capacity(capacity) {}
+
+	// Ring size for assets created from now on; call before the first tick or replay.
+	void set_capacity(size_t capacity) { m_capacity = capacity; }
+
+	AssetSeries& slot(AssetId asset)
+	{
+		if (asset >= m_slots.size())
+		{
+			m_slots.resize(asset + 1);
+		}
+		if (!m_slots[asset])
+		{
+			m_slots[asset] = std::make_unique<AssetSeries>(m_capacity);
+		}
+		return *m_slots[asset];
+	}
+
+	const AssetSeries* find_slot(AssetId asset) const { return asset < m_slots.size() ? m_slots[asset].get() : nullptr; }
+
+	TimeSeries& series(AssetId asset) { return slot(asset).recent; }
+
+	const TimeSeries* find(AssetId asset) const
+	{
+		const AssetSeries* found = find_slot(asset);
+		return found ? &found->recent : nullptr;
+	}
+
+	const LodPyramid* find_lod(AssetId asset) const
+	{
+		const AssetSeries* found = find_slot(asset);
+		return found ? &found->lod : nullptr;
+	}
+
+	const CandleSet* find_candles(AssetId asset) const
+	{
+		const AssetSeries* found = find_slot(asset);
+		return found ? &found->candles : nullptr;
+	}
+
+	// Long-retention compressed copy of every tick; the ring above only holds the most recent window.
+	CompressedSeries& archive(AssetId asset) { return slot(asset).archive; }
+
+	const CompressedSeries* find_archive(AssetId asset) const
+	{
+		const AssetSeries* found = find_slot(asset);
+		return found ? &found->archive : nullptr;
+	}
+
+	// Bars of one interval over everything the archive still holds, which reaches well past the ring and the live
+	// candle rings. Sized for the retention window, so use it for hourly or coarser intervals.
+	CandleSeries archive_candles(AssetId asset, double interval) const
+	{
+		CandleSeries candles(interval, static_cast<size_t>(archive_retention_seconds / interval) + 2);
+		if (const CompressedSeries* archive = find_archive(asset))
+		{
+			archive->for_each_since(0.0, [&](double timestamp, float price) { candles.append(timestamp, price); });
+		}
+		return candles;
+	}
+
+	size_t archive_bytes() const
+	{
+		size_t total = 0;
+		for (const auto& slot : m_slots)
+		{
+			total += slot ? slot->archive.memory_bytes() : 0;
+		}
+		return total;
+	}
+
+	// Drops ticks that are not newer than the last stored one, e.g. a repeated quote with an unchanged exchange time.
+	bool append(AssetId asset, const PricePoint& point)
+	{
+		if (!append_recent(asset, point))
+		{
+			return false;
+		}
+		slot(asset).archive.append(point.timestamp, point.price);
+		return true;
+	}
+
+	// Updates the ring, its LOD pyramid and the candles only; used when the archive already holds the tick (journal replay).
+	bool append_recent(AssetId asset, const PricePoint& point)
+	{
+		AssetSeries& target = slot(asset);
+		if (!target.recent.empty() && point.timestamp <= target.recent.back().timestamp)
+		{
+			return false;
+		}
+		target.recent.push(point);
+		target.lod.append(point.timestamp, point.price);
+		target.candles.append(point.timestamp, point.price);
+		return true;
+	}
+
+	void erase(AssetId asset)
+	{
+		if (asset < m_slots.size())
+		{
+			m_slots[asset].reset();
+		}
+	}
+
+  private:
+	size_t m_capacity;
+	std::vector<std::unique_ptr<AssetSeries>> m_slots;
+};
+
+#endif // SERIES_STORE_HPP
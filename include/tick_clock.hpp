@@ -0,0 +1,23 @@
+#ifndef TICK_CLOCK_HPP
+#define TICK_CLOCK_HPP
+
+#include <chrono>
+
+// Single time base for ticks: steady_clock readings mapped onto Unix seconds through one anchor taken at startup.
+// Timestamps never jump backwards with wall-clock adjustments but still line up with exchange and market_chart times.
+class TickClock
+{
+  public:
+	TickClock() : m_steady_anchor(std::chrono::steady_clock::now()), m_wall_anchor(std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count()) {}
+
+	double to_wall(std::chrono::steady_clock::time_point time) const { return m_wall_anchor + std::chrono::duration<double>(time - m_steady_anchor).count(); }
+	double now() const { return to_wall(std::chrono::steady_clock::now()); }
+
+  private:
+	std::chrono::steady_clock::time_point m_steady_anchor;
+	double m_wall_anchor;
+};
+
+TickClock g_tick_clock;
+
+#endif // TICK_CLOCK_HPP
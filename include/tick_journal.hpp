@@ -0,0 +1,696 @@
+#ifndef TICK_JOURNAL_HPP
+#define TICK_JOURNAL_HPP
+
+#include "gorilla.hpp"
+#include "series_store.hpp"
+#include "spsc_queue.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// On-disk layout per asset, both files starting with a 16 byte JournalHeader:
+//   <id>.ticks   write-ahead log of raw 16 byte records for ticks not yet sealed into a block
+//   <id>.blocks  Gorilla-compressed blocks of journal_block_points ticks each (see gorilla.hpp)
+// Once a block is sealed and flushed the log is truncated back to its header. A torn record or block at the tail
+// (crash mid-write) is skipped on replay and cut off when the journal is reopened for writing. Blocks older than
+// archive_retention_seconds are neither replayed nor kept: the .blocks file is compacted as they expire. The
+// directory's .lock file keeps a second process from writing the same journal (see JournalLock).
+struct JournalHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t record_size;
+};
+
+struct JournalRecord
+{
+	double timestamp;
+	float price;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(JournalHeader) == 16, "journal header layout");
+static_assert(sizeof(JournalRecord) == 16, "journal record layout");
+
+constexpr char journal_magic[8]         = {'T', 'M', 'T', 'I', 'C', 'K', '0', '1'};
+constexpr char blocks_magic[8]          = {'T', 'M', 'B', 'L', 'K', '0', '0', '2'};
+constexpr uint32_t journal_version      = 1;
+constexpr uint32_t journal_block_points = 4096;
+constexpr const char* journal_suffix    = ".ticks";
+constexpr const char* blocks_suffix     = ".blocks";
+constexpr const char* journal_lock_name = ".lock";
+
+std::string journal_file_stem(const std::string& id)
+{
+	std::string name = id;
+	for (char& c : name)
+	{
+		bool safe = (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+		if (!safe)
+		{
+			c = '_';
+		}
+	}
+	return name;
+}
+
+JournalHeader make_journal_header(const char (&magic)[8], uint32_t record_size)
+{
+	JournalHeader header{};
+	std::memcpy(header.magic, magic, sizeof(header.magic));
+	header.version	   = journal_version;
+	header.record_size = record_size;
+	return header;
+}
+
+bool valid_journal_header(const JournalHeader& header, const char (&magic)[8], uint32_t record_size)
+{
+	return std::memcmp(header.magic, magic, sizeof(header.magic)) == 0 && header.version == journal_version && header.record_size == record_size;
+}
+
+// Read-only private mapping of a whole file. With copy the file is read into memory instead: a mapping raises SIGBUS
+// on pages another process truncates away underneath it, whereas a copy just comes out short.
+class MappedFile
+{
+  public:
+	explicit MappedFile(const std::filesystem::path& path, bool copy = false)
+	{
+		int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			return;
+		}
+		struct stat info{};
+		if (::fstat(fd, &info) == 0 && info.st_size > 0 && copy)
+		{
+			m_copy.resize(static_cast<size_t>(info.st_size));
+			size_t length = 0;
+			while (length < m_copy.size())
+			{
+				const ssize_t got = ::pread(fd, m_copy.data() + length, m_copy.size() - length, static_cast<off_t>(length));
+				if (got <= 0)
+				{
+					break;
+				}
+				length += static_cast<size_t>(got);
+			}
+			m_copy.resize(length);
+			m_data = m_copy.data();
+			m_size = length;
+		}
+		else if (info.st_size > 0)
+		{
+			void* mapped = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapped != MAP_FAILED)
+			{
+				m_data	 = static_cast<const char*>(mapped);
+				m_size	 = static_cast<size_t>(info.st_size);
+				m_mapped = true;
+			}
+		}
+		::close(fd);
+	}
+
+	MappedFile(const MappedFile&)			 = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile()
+	{
+		if (m_mapped)
+		{
+			::munmap(const_cast<char*>(m_data), m_size);
+		}
+	}
+
+	const char* data() const { return m_data; }
+	size_t size() const { return m_size; }
+
+	bool has_header(const char (&magic)[8], uint32_t record_size) const
+	{
+		if (m_size < sizeof(JournalHeader))
+		{
+			return false;
+		}
+		JournalHeader header{};
+		std::memcpy(&header, m_data, sizeof(header));
+		return valid_journal_header(header, magic, record_size);
+	}
+
+  private:
+	const char* m_data = nullptr;
+	size_t m_size	   = 0;
+	bool m_mapped	   = false;
+	std::vector<char> m_copy;
+};
+
+// flock() on the journal directory's lock file. The writing process holds it exclusively for as long as it journals,
+// since two writers would append to and truncate the same files under each other. Released on destruction.
+class JournalLock
+{
+  public:
+	JournalLock() = default;
+	JournalLock(const JournalLock&)			   = delete;
+	JournalLock& operator=(const JournalLock&) = delete;
+	~JournalLock() { release(); }
+
+	// operation is LOCK_EX or LOCK_SH; never blocks. Returns false when another process holds a conflicting lock.
+	bool acquire(const std::string& dir, int operation)
+	{
+		release();
+		const std::string path = (std::filesystem::path(dir) / journal_lock_name).string();
+		m_fd				   = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+		if (m_fd < 0)
+		{
+			std::cerr << "Failed to open " << path << "\n";
+			return false;
+		}
+		if (::flock(m_fd, operation | LOCK_NB) != 0)
+		{
+			release();
+			return false;
+		}
+		return true;
+	}
+
+	void release()
+	{
+		if (m_fd >= 0)
+		{
+			::close(m_fd);
+			m_fd = -1;
+		}
+	}
+
+  private:
+	int m_fd = -1;
+};
+
+// Byte range and end time of one framed block inside a .blocks file.
+struct BlockFrame
+{
+	size_t begin;
+	size_t end;
+	int64_t last_ms;
+};
+
+// Frames of a mapped .blocks file up to the first torn or corrupt one. Only the frame headers are read.
+std::vector<BlockFrame> scan_journal_blocks(const MappedFile& file)
+{
+	std::vector<BlockFrame> frames;
+	if (!file.has_header(blocks_magic, sizeof(GorillaBlockHeader)))
+	{
+		return frames;
+	}
+	size_t offset	= sizeof(JournalHeader);
+	const char* end = file.data() + file.size();
+	GorillaBlockHeader header{};
+	while (peek_gorilla_block(file.data() + offset, end, header))
+	{
+		const size_t frame_end = offset + gorilla_frame_size(header);
+		frames.push_back({offset, frame_end, header.last_ms});
+		offset = frame_end;
+	}
+	return frames;
+}
+
+// Index of the first frame inside the retention window, measured from the newest frame like CompressedSeries::trim.
+size_t first_retained_block(const std::vector<BlockFrame>& frames, int64_t retention_ms)
+{
+	if (frames.empty())
+	{
+		return 0;
+	}
+	const int64_t cutoff_ms = frames.back().last_ms - retention_ms;
+	size_t first			= 0;
+	while (first < frames.size() && frames[first].last_ms < cutoff_ms)
+	{
+		++first;
+	}
+	return first;
+}
+
+void replay_blocks(const MappedFile& file, AssetId asset, SeriesStore& store)
+{
+	const TimeSeries& series  = store.series(asset);
+	CompressedSeries& archive = store.archive(asset);
+
+	// Expired blocks still on disk (the writer compacts lazily) are never copied out of the file.
+	const std::vector<BlockFrame> frames = scan_journal_blocks(file);
+	const size_t retained				 = first_retained_block(frames, archive.retention_ms());
+	std::vector<GorillaBlock> blocks(frames.size() - retained);
+	for (size_t idx_for_i = 0; idx_for_i < blocks.size(); ++idx_for_i)
+	{
+		const char* cursor = file.data() + frames[retained + idx_for_i].begin;
+		read_gorilla_block(cursor, file.data() + file.size(), blocks[idx_for_i]);
+	}
+
+	// Only the blocks that overlap the ring window are decoded; the rest stay compressed in the archive.
+	size_t first  = blocks.size();
+	size_t needed = 0;
+	while (first > 0 && needed < series.capacity())
+	{
+		--first;
+		needed += blocks[first].count;
+	}
+
+	for (size_t idx_for_i = first; idx_for_i < blocks.size(); ++idx_for_i)
+	{
+		GorillaDecoder decoder(blocks[idx_for_i]);
+		int64_t timestamp_ms = 0;
+		float price			 = 0.0F;
+		while (decoder.next(timestamp_ms, price))
+		{
+			store.append_recent(asset, {static_cast<double>(timestamp_ms) / 1000.0, price});
+		}
+	}
+
+	for (auto& block : blocks)
+	{
+		archive.add_sealed(std::move(block));
+	}
+}
+
+size_t replay_ticks(const MappedFile& file, AssetId asset, SeriesStore& store)
+{
+	if (!file.has_header(journal_magic, sizeof(JournalRecord)))
+	{
+		return 0;
+	}
+
+	const auto* records = reinterpret_cast<const JournalRecord*>(file.data() + sizeof(JournalHeader));
+	const size_t count	= (file.size() - sizeof(JournalHeader)) / sizeof(JournalRecord);
+	size_t replayed		= 0;
+	for (size_t idx_for_i = 0; idx_for_i < count; ++idx_for_i)
+	{
+		replayed += store.append(asset, {records[idx_for_i].timestamp, records[idx_for_i].price}) ? 1 : 0;
+	}
+	return replayed;
+}
+
+// Maps every journal in dir. Compressed blocks are adopted into the archive as-is and only the newest ones are
+// decoded into the ring, then the write-ahead log is replayed on top, so startup cost tracks the ring size rather
+// than the journal size. Pass owned when this process holds the journal (TickJournal::start succeeded); otherwise
+// another process may be sealing blocks and truncating the files meanwhile, so they are copied rather than mapped.
+size_t replay_tick_journal(const std::string& dir, AssetRegistry& assets, SeriesStore& store, bool owned)
+{
+	std::error_code ec;
+	if (!std::filesystem::is_directory(dir, ec))
+	{
+		return 0;
+	}
+
+	std::set<std::string> ids;
+	for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+	{
+		const auto extension = entry.path().extension();
+		if (entry.is_regular_file() && (extension == journal_suffix || extension == blocks_suffix))
+		{
+			ids.insert(entry.path().stem().string());
+		}
+	}
+
+	size_t replayed = 0;
+	for (const auto& id : ids)
+	{
+		const std::filesystem::path base = std::filesystem::path(dir) / id;
+		const AssetId asset				 = assets.intern(id);
+		const size_t before				 = store.series(asset).size();
+		// The log is read first: a block sealed in between is then seen in both files rather than in neither, and
+		// the replay drops the duplicates by timestamp.
+		const MappedFile ticks(base.string() + journal_suffix, !owned);
+		const MappedFile blocks(base.string() + blocks_suffix, !owned);
+		replay_blocks(blocks, asset, store);
+		replayed += store.series(asset).size() - before;
+		replayed += replay_ticks(ticks, asset, store);
+	}
+	return replayed;
+}
+
+// Appends ticks to the per-asset journals from a background flusher. append() is meant for a single producer (the
+// thread that applies price snapshots) and never touches the disk itself.
+class TickJournal
+{
+  public:
+	explicit TickJournal(std::chrono::milliseconds flush_interval = std::chrono::seconds(1)) : m_flush_interval(flush_interval) {}
+	TickJournal(const TickJournal&)			   = delete;
+	TickJournal& operator=(const TickJournal&) = delete;
+	~TickJournal() { stop(); }
+
+	// Returns false and leaves journaling off when another process already writes to dir.
+	bool start(const std::string& dir)
+	{
+		if (m_thread.joinable())
+		{
+			return true;
+		}
+		std::error_code ec;
+		std::filesystem::create_directories(dir, ec);
+		if (!m_lock.acquire(dir, LOCK_EX))
+		{
+			std::cerr << "Tick journal " << dir << " is in use by another process, ticks will not be journaled\n";
+			return false;
+		}
+		m_dir	 = dir;
+		m_stop	 = false;
+		m_thread = std::thread(&TickJournal::run, this);
+		return true;
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_cv.notify_one();
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+		m_lock.release();
+	}
+
+	void append(const std::string& id, const PricePoint& point)
+	{
+		if (!m_thread.joinable())
+		{
+			return;
+		}
+		if (!m_queue.push({id, point}))
+		{
+			std::cerr << "Tick journal queue full, tick for " << id << " dropped\n";
+		}
+	}
+
+  private:
+	struct Entry
+	{
+		std::string id;
+		PricePoint point;
+	};
+
+	struct JournalFiles
+	{
+		std::string name;
+		std::string blocks_path;
+		FILE* ticks		  = nullptr;
+		FILE* blocks	  = nullptr;
+		int64_t last_ms	  = INT64_MIN;
+		size_t blocks_end = sizeof(JournalHeader);
+		std::vector<BlockFrame> frames;
+		GorillaBlock open;
+		GorillaEncoder encoder;
+	};
+
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true)
+		{
+			m_cv.wait_for(lock, m_flush_interval, [this] { return m_stop; });
+			bool stopping = m_stop;
+			lock.unlock();
+
+			flush();
+
+			if (stopping)
+			{
+				break;
+			}
+			lock.lock();
+		}
+
+		for (auto& [id, files] : m_files)
+		{
+			std::fclose(files.ticks);
+			if (files.blocks)
+			{
+				std::fclose(files.blocks);
+			}
+		}
+		m_files.clear();
+	}
+
+	void flush()
+	{
+		Entry entry;
+		std::set<JournalFiles*> touched;
+		while (m_queue.pop(entry))
+		{
+			JournalFiles* files = open_journal(entry.id);
+			if (files && write_tick(*files, entry.point))
+			{
+				touched.insert(files);
+			}
+		}
+
+		for (JournalFiles* files : touched)
+		{
+			if (std::fflush(files->ticks) != 0)
+			{
+				std::cerr << "Failed to append to tick journal for " << files->name << "\n";
+			}
+		}
+	}
+
+	bool write_tick(JournalFiles& files, const PricePoint& point)
+	{
+		const int64_t timestamp_ms = to_millis(point.timestamp);
+		if (timestamp_ms <= files.last_ms)
+		{
+			return false;
+		}
+
+		JournalRecord record{point.timestamp, point.price, 0};
+		if (std::fwrite(&record, sizeof(record), 1, files.ticks) != 1)
+		{
+			std::cerr << "Failed to append to tick journal for " << files.name << "\n";
+			return false;
+		}
+		files.encoder.append(files.open, timestamp_ms, point.price);
+		files.last_ms = timestamp_ms;
+
+		if (files.open.count >= journal_block_points)
+		{
+			seal_block(files);
+		}
+		return true;
+	}
+
+	// The log is only truncated after the block is safely appended; a crash in between leaves duplicates that
+	// replay and open_journal() skip by timestamp.
+	void seal_block(JournalFiles& files)
+	{
+		if (!files.blocks)
+		{
+			return;
+		}
+		if (std::fflush(files.ticks) != 0 || !write_gorilla_block(files.blocks, files.open) || std::fflush(files.blocks) != 0)
+		{
+			// Cut a partial frame back off so the retry on the next tick does not append behind it.
+			std::cerr << "Failed to seal tick block for " << files.name << "\n";
+			if (::ftruncate(::fileno(files.blocks), static_cast<off_t>(files.blocks_end)) != 0)
+			{
+				std::cerr << "Failed to repair " << files.blocks_path << "\n";
+			}
+			return;
+		}
+		if (::ftruncate(::fileno(files.ticks), sizeof(JournalHeader)) != 0)
+		{
+			std::cerr << "Failed to truncate tick journal for " << files.name << "\n";
+		}
+
+		const size_t begin = files.blocks_end;
+		files.blocks_end += sizeof(GorillaBlockHeader) + files.open.words.size() * sizeof(uint64_t);
+		files.frames.push_back({begin, files.blocks_end, files.open.last_ms});
+		files.open	  = GorillaBlock();
+		files.encoder = GorillaEncoder();
+		compact_blocks(files);
+	}
+
+	// Rewrites the .blocks file without the frames that fell out of the retention window. Waits until the expired
+	// prefix is a quarter of the file, so the copy is amortised over many seals.
+	void compact_blocks(JournalFiles& files)
+	{
+		const size_t retained = first_retained_block(files.frames, to_millis(archive_retention_seconds));
+		if (retained == 0 || (files.frames[retained].begin - sizeof(JournalHeader)) * 4 < files.blocks_end)
+		{
+			return;
+		}
+
+		const size_t cut			= files.frames[retained].begin - sizeof(JournalHeader);
+		const std::string tmp_path	= files.blocks_path + ".tmp";
+		bool written				= false;
+		{
+			MappedFile existing(files.blocks_path);
+			FILE* out = existing.size() >= files.blocks_end ? std::fopen(tmp_path.c_str(), "wb") : nullptr;
+			if (out)
+			{
+				const JournalHeader header = make_journal_header(blocks_magic, sizeof(GorillaBlockHeader));
+				const size_t kept		   = files.blocks_end - files.frames[retained].begin;
+				written = std::fwrite(&header, sizeof(header), 1, out) == 1 && std::fwrite(existing.data() + files.frames[retained].begin, 1, kept, out) == kept &&
+						  std::fflush(out) == 0;
+				written = std::fclose(out) == 0 && written;
+			}
+		}
+
+		std::error_code ec;
+		if (written)
+		{
+			std::filesystem::rename(tmp_path, files.blocks_path, ec);
+		}
+		if (!written || ec)
+		{
+			std::cerr << "Failed to compact " << files.blocks_path << "\n";
+			std::filesystem::remove(tmp_path, ec);
+			return;
+		}
+
+		std::fclose(files.blocks);
+		files.blocks = std::fopen(files.blocks_path.c_str(), "ab");
+		if (!files.blocks)
+		{
+			std::cerr << "Failed to reopen " << files.blocks_path << "\n";
+		}
+		files.frames.erase(files.frames.begin(), files.frames.begin() + static_cast<std::ptrdiff_t>(retained));
+		for (auto& frame : files.frames)
+		{
+			frame.begin -= cut;
+			frame.end -= cut;
+		}
+		files.blocks_end -= cut;
+	}
+
+	JournalFiles* open_journal(const std::string& id)
+	{
+		auto it = m_files.find(id);
+		if (it != m_files.end())
+		{
+			return &it->second;
+		}
+
+		const std::filesystem::path base = std::filesystem::path(m_dir) / journal_file_stem(id);
+		const std::string ticks_path	 = base.string() + journal_suffix;
+		const std::string blocks_path	 = base.string() + blocks_suffix;
+
+		JournalFiles files;
+		files.name		  = id;
+		files.blocks_path = blocks_path;
+
+		// Anything past the last intact frame is a torn write and is cut off below, before new blocks follow it.
+		bool blocks_valid = false;
+		{
+			MappedFile existing(blocks_path);
+			blocks_valid = existing.has_header(blocks_magic, sizeof(GorillaBlockHeader));
+			files.frames = scan_journal_blocks(existing);
+			if (!files.frames.empty())
+			{
+				files.blocks_end = files.frames.back().end;
+				files.last_ms	 = files.frames.back().last_ms;
+			}
+		}
+
+		// Resume the open block from the records still sitting in the log.
+		bool ticks_valid = false;
+		size_t ticks_end = 0;
+		{
+			MappedFile existing(ticks_path);
+			ticks_valid = existing.has_header(journal_magic, sizeof(JournalRecord));
+			if (ticks_valid)
+			{
+				const auto* records = reinterpret_cast<const JournalRecord*>(existing.data() + sizeof(JournalHeader));
+				const size_t count	= (existing.size() - sizeof(JournalHeader)) / sizeof(JournalRecord);
+				ticks_end			= sizeof(JournalHeader) + count * sizeof(JournalRecord);
+				for (size_t idx_for_i = 0; idx_for_i < count; ++idx_for_i)
+				{
+					const int64_t timestamp_ms = to_millis(records[idx_for_i].timestamp);
+					if (timestamp_ms > files.last_ms)
+					{
+						files.encoder.append(files.open, timestamp_ms, records[idx_for_i].price);
+						files.last_ms = timestamp_ms;
+					}
+				}
+			}
+		}
+
+		files.ticks	 = open_with_header(ticks_path, ticks_valid, ticks_end, journal_magic, sizeof(JournalRecord));
+		files.blocks = open_with_header(blocks_path, blocks_valid, files.blocks_end, blocks_magic, sizeof(GorillaBlockHeader));
+		if (!files.ticks || !files.blocks)
+		{
+			std::cerr << "Failed to open tick journal " << base << "\n";
+			if (files.ticks)
+			{
+				std::fclose(files.ticks);
+			}
+			if (files.blocks)
+			{
+				std::fclose(files.blocks);
+			}
+			return nullptr;
+		}
+
+		auto inserted = m_files.emplace(id, std::move(files));
+		compact_blocks(inserted.first->second);
+		return &inserted.first->second;
+	}
+
+	// Opens path for appending. A missing, empty or (when keep is false) invalid file starts over with a fresh header;
+	// when valid_end is non-zero the file is cut back to it to drop a torn tail record.
+	static FILE* open_with_header(const std::string& path, bool keep, size_t valid_end, const char (&magic)[8], uint32_t record_size)
+	{
+		// Always append mode: seal_block() truncates the log under the stream and writes must follow the new end.
+		FILE* file = std::fopen(path.c_str(), "ab");
+		if (!file)
+		{
+			return nullptr;
+		}
+		if (!keep && ::ftruncate(::fileno(file), 0) != 0)
+		{
+			std::fclose(file);
+			return nullptr;
+		}
+
+		std::fseek(file, 0, SEEK_END);
+		long size = std::ftell(file);
+		if (size <= 0)
+		{
+			JournalHeader header = make_journal_header(magic, record_size);
+			std::fwrite(&header, sizeof(header), 1, file);
+			std::fflush(file);
+		}
+		else if (valid_end > 0 && static_cast<size_t>(size) > valid_end && ::ftruncate(::fileno(file), static_cast<off_t>(valid_end)) != 0)
+		{
+			std::cerr << "Failed to repair " << path << "\n";
+		}
+		return file;
+	}
+
+	std::chrono::milliseconds m_flush_interval;
+	std::string m_dir;
+	JournalLock m_lock;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_stop = false;
+
+	SpscQueue<Entry, 4096> m_queue;
+	std::map<std::string, JournalFiles> m_files;
+};
+
+#endif // TICK_JOURNAL_HPP
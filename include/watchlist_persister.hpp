@@ -0,0 +1,135 @@
+#ifndef WATCHLIST_PERSISTER_HPP
+#define WATCHLIST_PERSISTER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+bool save_watchlist(const std::string& path, const std::vector<std::string>& watchlist)
+{
+	const std::string tmp_path = path + ".tmp";
+	{
+		std::ofstream file(tmp_path, std::ios::trunc);
+		if (!file)
+		{
+			std::cerr << "Failed to save watchlist to " << tmp_path << "\n";
+			return false;
+		}
+
+		for (const auto& id : watchlist)
+		{
+			file << id << "\n";
+		}
+
+		file.flush();
+		if (!file)
+		{
+			std::cerr << "Failed to write watchlist to " << tmp_path << "\n";
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tmp_path, path, ec);
+	if (ec)
+	{
+		std::cerr << "Failed to replace " << path << ": " << ec.message() << "\n";
+		return false;
+	}
+	return true;
+}
+
+// Writes the watchlist from a background thread once it has stopped changing for the debounce interval. Only the
+// latest scheduled contents are written; stop() flushes anything still pending.
+class WatchlistPersister
+{
+  public:
+	explicit WatchlistPersister(std::chrono::milliseconds debounce = std::chrono::milliseconds(500)) : m_debounce(debounce) {}
+	WatchlistPersister(const WatchlistPersister&)			 = delete;
+	WatchlistPersister& operator=(const WatchlistPersister&) = delete;
+	~WatchlistPersister() { stop(); }
+
+	void start(const std::string& path)
+	{
+		if (m_thread.joinable())
+		{
+			return;
+		}
+		m_path	 = path;
+		m_stop	 = false;
+		m_thread = std::thread(&WatchlistPersister::run, this);
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_cv.notify_one();
+		if (m_thread.joinable())
+		{
+			m_thread.join();
+		}
+	}
+
+	void schedule(std::vector<std::string> watchlist)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pending  = std::move(watchlist);
+			m_dirty	   = true;
+			m_deadline = std::chrono::steady_clock::now() + m_debounce;
+		}
+		m_cv.notify_one();
+	}
+
+  private:
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true)
+		{
+			if (m_dirty)
+			{
+				m_cv.wait_until(lock, m_deadline, [this] { return m_stop || std::chrono::steady_clock::now() >= m_deadline; });
+			}
+			else
+			{
+				m_cv.wait(lock, [this] { return m_stop || m_dirty; });
+			}
+
+			if (m_dirty && (m_stop || std::chrono::steady_clock::now() >= m_deadline))
+			{
+				std::vector<std::string> watchlist = std::move(m_pending);
+				m_dirty							   = false;
+				lock.unlock();
+				save_watchlist(m_path, watchlist);
+				lock.lock();
+			}
+
+			if (m_stop && !m_dirty)
+			{
+				return;
+			}
+		}
+	}
+
+	std::chrono::milliseconds m_debounce;
+	std::string m_path;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_stop	 = false;
+	bool m_dirty = false;
+	std::chrono::steady_clock::time_point m_deadline;
+	std::vector<std::string> m_pending;
+};
+
+#endif // WATCHLIST_PERSISTER_HPP
@@ -0,0 +1,187 @@
+#include "../include/coingecko.hpp"
+#include "../include/indicators.hpp"
+#include "../include/json.hpp"
+#include "../include/series_store.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Random walk with a fixed seed, so every run and every machine measures the same input.
+std::vector<double> bench_prices(size_t count)
+{
+	std::mt19937_64 random(7);
+	std::normal_distribution<double> step(0.0, 0.002);
+	std::vector<double> prices(count);
+	double price = 30000.0;
+	for (auto& value : prices)
+	{
+		price *= 1.0 + step(random);
+		value = price;
+	}
+	return prices;
+}
+
+// market_chart-shaped payload with `count` five-minute points.
+std::string bench_market_chart(size_t count)
+{
+	const std::vector<double> prices = bench_prices(count);
+	std::string body				 = "{\"prices\":[";
+	body.reserve(count * 36 + 64);
+	char point[64];
+	for (size_t idx_for_i = 0; idx_for_i < count; ++idx_for_i)
+	{
+		std::snprintf(point, sizeof(point), "%s[%lld,%.10g]", idx_for_i ? "," : "", 1700000000000LL + static_cast<long long>(idx_for_i) * 300000LL, prices[idx_for_i]);
+		body += point;
+	}
+	return body + "],\"market_caps\":[],\"total_volumes\":[]}";
+}
+
+void set_points_processed(benchmark::State& state)
+{
+	state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+// compute_rsi only looks at the last period + 1 prices, so its cost should stay flat across sizes.
+void BM_compute_rsi(benchmark::State& state)
+{
+	const std::vector<double> prices = bench_prices(static_cast<size_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(compute_rsi(prices));
+	}
+}
+
+void BM_compute_macd(benchmark::State& state)
+{
+	const std::vector<double> prices = bench_prices(static_cast<size_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		double macd	  = 0.0;
+		double signal = 0.0;
+		compute_macd(prices, macd, signal);
+		benchmark::DoNotOptimize(macd);
+		benchmark::DoNotOptimize(signal);
+	}
+	set_points_processed(state);
+}
+
+void BM_compute_macd_series(benchmark::State& state)
+{
+	const std::vector<double> prices = bench_prices(static_cast<size_t>(state.range(0)));
+	MacdSeries series;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(compute_macd_series(prices, series));
+		benchmark::ClobberMemory();
+	}
+	set_points_processed(state);
+}
+
+// The per-tick path once a series is seeded.
+void BM_indicator_update(benchmark::State& state)
+{
+	const std::vector<double> prices = bench_prices(static_cast<size_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		IndicatorState indicators;
+		for (double price : prices)
+		{
+			indicators.update(price);
+		}
+		benchmark::DoNotOptimize(indicators.snapshot());
+	}
+	set_points_processed(state);
+}
+
+// DOM parse plus the walk the old history loader did over the resulting tree.
+void BM_market_chart_dom(benchmark::State& state)
+{
+	const std::string payload = bench_market_chart(static_cast<size_t>(state.range(0)));
+	std::vector<double> times;
+	std::vector<double> prices;
+	for (auto _ : state)
+	{
+		times.clear();
+		prices.clear();
+		nlohmann::json data = nlohmann::json::parse(payload);
+		for (const auto& point : data["prices"])
+		{
+			times.push_back(point[0].get<double>() / 1000.0);
+			prices.push_back(point[1].get<double>());
+		}
+		benchmark::DoNotOptimize(prices.data());
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(payload.size()));
+	set_points_processed(state);
+}
+
+// The streaming SAX path the client uses, fed in 16 KiB chunks like curl's write callback.
+void BM_market_chart_stream(benchmark::State& state)
+{
+	const std::string payload = bench_market_chart(static_cast<size_t>(state.range(0)));
+	std::vector<double> times;
+	std::vector<double> prices;
+	for (auto _ : state)
+	{
+		times.clear();
+		prices.clear();
+		MarketChartStream stream(times, prices);
+		for (size_t offset = 0; offset < payload.size(); offset += 16384)
+		{
+			stream.feed(payload.data() + offset, std::min<size_t>(16384, payload.size() - offset));
+		}
+		benchmark::DoNotOptimize(stream.tokenizer.finish());
+	}
+	state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(payload.size()));
+	set_points_processed(state);
+}
+
+// Ring push at the default capacity; past 12096 points every push also evicts the oldest tick. The ring is built once
+// and reaches its full size during the first iterations, so the timed loop measures pushes rather than its growth.
+void BM_time_series_push(benchmark::State& state)
+{
+	const std::vector<double> prices = bench_prices(static_cast<size_t>(state.range(0)));
+	TimeSeries series;
+	for (auto _ : state)
+	{
+		for (size_t idx_for_i = 0; idx_for_i < prices.size(); ++idx_for_i)
+		{
+			series.push({1700000000.0 + static_cast<double>(idx_for_i), static_cast<float>(prices[idx_for_i])});
+		}
+		benchmark::DoNotOptimize(series.offset());
+	}
+	set_points_processed(state);
+}
+
+// Full per-tick store maintenance: ring, LOD pyramid, candles and the compressed archive.
+void BM_series_store_append(benchmark::State& state)
+{
+	const std::vector<double> prices = bench_prices(static_cast<size_t>(state.range(0)));
+	for (auto _ : state)
+	{
+		SeriesStore store;
+		for (size_t idx_for_i = 0; idx_for_i < prices.size(); ++idx_for_i)
+		{
+			store.append(0, {1700000000.0 + static_cast<double>(idx_for_i), static_cast<float>(prices[idx_for_i])});
+		}
+		benchmark::DoNotOptimize(store.find(0));
+	}
+	set_points_processed(state);
+}
+
+BENCHMARK(BM_compute_rsi)->RangeMultiplier(10)->Range(1000, 10000000);
+BENCHMARK(BM_compute_macd)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_compute_macd_series)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_indicator_update)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMicrosecond);
+// Payloads stop at 1M points (~35 MB); the DOM at 10M needs several GB.
+BENCHMARK(BM_market_chart_dom)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_market_chart_stream)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_time_series_push)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_series_store_append)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
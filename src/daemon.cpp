@@ -0,0 +1,219 @@
+#include "../include/market_bus.hpp"
+#include "../include/market_state.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+volatile std::sig_atomic_t g_daemon_stop = 0;
+std::mutex g_daemon_mutex;
+std::condition_variable g_daemon_cv;
+bool g_daemon_wake = false;
+MarketBusWriter g_market_bus;
+
+// The daemon never plots, so its rings only need to order incoming ticks; the archive keeps the full history. One
+// hour of 5 s ticks is about 12 KB per asset instead of 190 KB.
+constexpr size_t daemon_ring_points = 720;
+
+void on_daemon_signal(int) { g_daemon_stop = 1; }
+
+// Called on the ingest thread after each published snapshot.
+void wake_daemon()
+{
+	{
+		std::lock_guard<std::mutex> lock(g_daemon_mutex);
+		g_daemon_wake = true;
+	}
+	g_daemon_cv.notify_one();
+}
+
+// Indicators start from the hourly bars of whatever the journal replay put in the archive, so the daemon needs no
+// history downloads and still sees the full retention window.
+void seed_indicators_from_store(AssetId asset)
+{
+	const CandleSeries bars = g_price_history.archive_candles(asset, candle_intervals[indicator_interval]);
+	ProfileScope seed_scope(ProfileZone::seed);
+	g_indicators.seed_closed(asset, bars);
+}
+
+// Picks up watchlist edits saved by a viewer running with --bus. New assets are seeded from the store, dropped ones
+// lose their indicators, and the bus is reopened larger when the watchlist outgrows it.
+void reload_daemon_watchlist(const std::string& path, const std::string& bus_name)
+{
+	const std::vector<std::string> previous = reload_watchlist(path);
+	for (const auto& id : previous)
+	{
+		const AssetId asset = g_assets.intern(id);
+		if (!g_assets.watched(asset))
+		{
+			g_indicators.erase(asset);
+		}
+	}
+	for (const auto& id : g_crypto_watchlist)
+	{
+		const AssetId asset = g_assets.intern(id);
+		if (!g_indicators.contains(asset))
+		{
+			seed_indicators_from_store(asset);
+		}
+	}
+	g_ingest.set_watchlist(g_crypto_watchlist);
+
+	if (g_market_bus.is_open() && g_crypto_watchlist.size() > g_market_bus.max_assets())
+	{
+		g_market_bus.open(bus_name, bus_assets_for(g_crypto_watchlist.size()));
+	}
+	std::cout << "watchlist " << path << " reloaded, tracking " << g_crypto_watchlist.size() << " assets\n";
+}
+
+void print_usage(const char* program)
+{
+	std::cerr << "usage: " << program << " [--watchlist <path>] [--data <dir>] [--status <seconds>] [--bus <name> | --no-bus] [--profile-dump <path>]\n";
+}
+
+int main(int argc, char** argv)
+{
+	std::string watchlist_path = "config/watchlist.txt";
+	std::string data_dir	   = "data/ticks";
+	std::string bus_name	   = bus_default_name;
+	long status_seconds		   = 60;
+	std::string profile_path;
+	for (int idx_for_i = 1; idx_for_i < argc; ++idx_for_i)
+	{
+		const std::string arg = argv[idx_for_i];
+		if (arg == "--watchlist" && idx_for_i + 1 < argc)
+		{
+			watchlist_path = argv[++idx_for_i];
+		}
+		else if (arg == "--data" && idx_for_i + 1 < argc)
+		{
+			data_dir = argv[++idx_for_i];
+		}
+		else if (arg == "--bus" && idx_for_i + 1 < argc)
+		{
+			bus_name = argv[++idx_for_i];
+		}
+		else if (arg == "--no-bus")
+		{
+			bus_name.clear();
+		}
+		else if (arg == "--profile-dump" && idx_for_i + 1 < argc)
+		{
+			profile_path = argv[++idx_for_i];
+		}
+		else if (arg == "--status" && idx_for_i + 1 < argc)
+		{
+			status_seconds = std::strtol(argv[++idx_for_i], nullptr, 10);
+		}
+		else
+		{
+			print_usage(argv[0]);
+			return -1;
+		}
+	}
+
+	curl_global_init(CURL_GLOBAL_DEFAULT);
+
+	g_api_key = read_api_key();
+	if (g_api_key.empty())
+	{
+		std::cerr << "failed to load api key \n";
+		return -1;
+	}
+	load_watchlist(watchlist_path);
+	if (g_crypto_watchlist.empty())
+	{
+		std::cerr << "watchlist " << watchlist_path << " is empty, nothing to poll\n";
+	}
+
+	if (!g_tick_journal.start(data_dir))
+	{
+		return -1;
+	}
+	g_price_history.set_capacity(daemon_ring_points);
+	const size_t replayed = replay_tick_journal(data_dir, g_assets, g_price_history, true);
+	for (const auto& id : g_crypto_watchlist)
+	{
+		seed_indicators_from_store(g_assets.intern(id));
+	}
+	std::cout << "replayed " << replayed << " ticks, tracking " << g_crypto_watchlist.size() << " assets\n";
+
+	if (!bus_name.empty() && g_market_bus.open(bus_name, bus_assets_for(g_crypto_watchlist.size())))
+	{
+		std::cout << "publishing to market bus " << bus_name << "\n";
+	}
+
+	std::signal(SIGINT, on_daemon_signal);
+	std::signal(SIGTERM, on_daemon_signal);
+
+	g_ingest.set_on_publish(wake_daemon);
+	g_ingest.set_watchlist(g_crypto_watchlist);
+	g_request_engine.start();
+	g_ingest.start(g_api_key);
+
+	const auto status_interval = std::chrono::seconds(status_seconds > 0 ? status_seconds : 60);
+	auto next_status		   = std::chrono::steady_clock::now() + status_interval;
+	size_t snapshots		   = 0;
+	size_t quotes			   = 0;
+	std::error_code watchlist_error;
+	auto watchlist_time = std::filesystem::last_write_time(watchlist_path, watchlist_error);
+
+	while (!g_daemon_stop)
+	{
+		{
+			// Signals cannot notify the condition variable, so the wait is bounded.
+			std::unique_lock<std::mutex> lock(g_daemon_mutex);
+			g_daemon_cv.wait_for(lock, std::chrono::seconds(1), [] { return g_daemon_wake; });
+			g_daemon_wake = false;
+		}
+
+		PriceSnapshot snapshot;
+		while (g_ingest.poll(snapshot))
+		{
+			apply_price_snapshot(snapshot);
+			g_market_bus.publish(snapshot);
+			++snapshots;
+			quotes += snapshot.quotes.size();
+		}
+		g_market_bus.heartbeat();
+
+		const auto modified = std::filesystem::last_write_time(watchlist_path, watchlist_error);
+		if (!watchlist_error && modified != watchlist_time)
+		{
+			watchlist_time = modified;
+			reload_daemon_watchlist(watchlist_path, bus_name);
+		}
+
+		if (std::chrono::steady_clock::now() >= next_status)
+		{
+			std::cout << "snapshots: " << snapshots << ", quotes: " << quotes << ", board version: " << g_market_board.version()
+					  << ", archive: " << g_price_history.archive_bytes() / 1024 << " KiB\n";
+			if (!profile_path.empty())
+			{
+				g_profiler.dump(profile_path, g_tick_clock.now());
+			}
+			next_status += status_interval;
+		}
+	}
+
+	std::cout << "shutting down\n";
+	g_ingest.stop();
+	g_request_engine.stop();
+	g_tick_journal.stop();
+	g_market_bus.close();
+	if (!profile_path.empty())
+	{
+		g_profiler.dump(profile_path, g_tick_clock.now());
+	}
+
+	g_curl_pool.shutdown();
+	curl_global_cleanup();
+
+	return 0;
+}
@@ -0,0 +1,161 @@
+#include "../include/alloc_counter.hpp"
+#include "../include/asset_rows.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+struct CheckOptions
+{
+	size_t assets = 200;
+	size_t ticks  = 20000;
+	size_t frames = 600;
+	size_t warmup = 120;
+};
+
+// Ticks every asset `ticks` times through the same path the viewer uses, so the board, the rings, their pyramids and
+// the candles all hold real data before the frames start.
+void fill_market(const CheckOptions& options)
+{
+	for (size_t idx_for_i = 0; idx_for_i < options.assets; ++idx_for_i)
+	{
+		g_crypto_watchlist.push_back("asset-" + std::to_string(idx_for_i));
+	}
+	rebuild_asset_rows();
+
+	PriceSnapshot snapshot;
+	snapshot.quotes.resize(options.assets);
+	for (size_t tick = 0; tick < options.ticks; ++tick)
+	{
+		snapshot.timestamp = 1.7e9 + static_cast<double>(tick) * 5.0;
+		for (size_t idx_for_i = 0; idx_for_i < options.assets; ++idx_for_i)
+		{
+			snapshot.quotes[idx_for_i].id	 = g_crypto_watchlist[idx_for_i];
+			snapshot.quotes[idx_for_i].price = static_cast<float>(100.0 + 10.0 * std::sin(static_cast<double>(tick + idx_for_i) * 0.01));
+		}
+		apply_price_snapshot(snapshot);
+	}
+}
+
+// The data work of one steady-state viewer frame, minus ImGui: the watchlist rows against the current board, the
+// focused asset's price LOD at a zoom level that changes per frame, the market_chart-style history LOD, the visible
+// candles of every interval and the profiler overlay's stats.
+double run_frame(size_t frame, AssetId focused, const HistorySeries& history, LodView& history_view, LodView& chart_view, std::vector<float>& scratch)
+{
+	double sink = 0.0;
+	auto board	= g_market_board.read();
+	for (const AssetRow& row : g_asset_rows)
+	{
+		sink += board ? board->price(row.asset) : 0.0F;
+		sink += static_cast<double>(row.focus_label.size() + row.remove_label.size());
+	}
+
+	const TimeSeries* recent = g_price_history.find(focused);
+	const LodPyramid* lod	 = g_price_history.find_lod(focused);
+	if (recent && lod && !recent->empty())
+	{
+		const double first = recent->timestamp(0);
+		const double span  = recent->back().timestamp - first;
+		const double zoom  = static_cast<double>(frame % 16 + 1) / 16.0;
+		lod->query(*recent, first + span * (1.0 - zoom), first + span, 1200, history_view);
+		sink += history_view.size();
+	}
+
+	history.lod.query(VectorSeriesView{history.times, history.prices}, history.times.front(), history.times.back(), 1200, chart_view);
+	sink += chart_view.size();
+
+	if (const CandleSet* candles = g_price_history.find_candles(focused))
+	{
+		for (size_t interval = 0; interval < candle_interval_count; ++interval)
+		{
+			const CandleSeries& series = candles->interval(interval);
+			for (size_t idx_for_i = 0; idx_for_i < series.size(); ++idx_for_i)
+			{
+				sink += series[idx_for_i].high - series[idx_for_i].low;
+			}
+		}
+	}
+
+	if (const IndicatorSeries* indicators = g_indicators.find(focused))
+	{
+		sink += indicators->last.rsi;
+	}
+
+	for (size_t zone = 0; zone < profile_zone_count; ++zone)
+	{
+		sink += g_profiler.stats(static_cast<ProfileZone>(zone), scratch).p99_ms;
+	}
+	return sink;
+}
+
+// Runs the viewer's steady-state frame work under the counting operator new and fails when any frame after warm-up
+// touches the heap. Built with TRADE_MARKET_COUNT_ALLOCS.
+int main(int argc, char** argv)
+{
+	CheckOptions options;
+	for (int idx_for_i = 1; idx_for_i + 1 < argc; idx_for_i += 2)
+	{
+		const std::string arg = argv[idx_for_i];
+		const size_t value	  = std::strtoul(argv[idx_for_i + 1], nullptr, 10);
+		if (arg == "--assets")
+		{
+			options.assets = value;
+		}
+		else if (arg == "--ticks")
+		{
+			options.ticks = value;
+		}
+		else if (arg == "--frames")
+		{
+			options.frames = value;
+		}
+		else if (arg == "--warmup")
+		{
+			options.warmup = value;
+		}
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--assets <n>] [--ticks <n>] [--frames <n>] [--warmup <n>]\n", argv[0]);
+			return -1;
+		}
+	}
+	if (options.assets == 0 || options.ticks == 0)
+	{
+		std::fprintf(stderr, "--assets and --ticks must be positive\n");
+		return -1;
+	}
+
+	fill_market(options);
+	const AssetId focused = g_asset_rows.front().asset;
+
+	HistorySeries history;
+	for (size_t idx_for_i = 0; idx_for_i < 2016; ++idx_for_i)
+	{
+		history.times.push_back(1.7e9 + static_cast<double>(idx_for_i) * 300.0);
+		history.prices.push_back(100.0 + std::cos(static_cast<double>(idx_for_i) * 0.05));
+	}
+	history.lod.build(history.times, history.prices);
+	g_indicators.seed_closed(focused, g_price_history.find_candles(focused)->interval(indicator_interval));
+
+	LodView history_view;
+	LodView chart_view;
+	std::vector<float> scratch;
+	FrameAllocationCheck check(options.warmup);
+	double sink = 0.0;
+	for (size_t frame = 0; frame < options.frames; ++frame)
+	{
+		check.begin_frame();
+		{
+			ProfileScope frame_scope(ProfileZone::frame);
+			sink += run_frame(frame, focused, history, history_view, chart_view, scratch);
+		}
+		check.end_frame(true);
+	}
+
+	std::printf("%zu frames after %zu warm-up, %zu of them allocated (checksum %.1f)\n", options.frames - std::min(options.frames, options.warmup), options.warmup,
+				check.violations(), sink);
+	return check.violations() == 0 ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+#include "../include/coingecko.hpp"
+#include "../include/mock_coingecko.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct LoadOptions
+{
+	std::string url;
+	size_t assets	   = 250;
+	size_t polls	   = 50;
+	size_t history	   = 100;
+	int days		   = 30;
+	size_t concurrency = 16;
+};
+
+double percentile(const std::vector<double>& sorted, double fraction)
+{
+	if (sorted.empty())
+	{
+		return 0.0;
+	}
+	const size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+	return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void print_latencies(const char* label, std::vector<double>& seconds, double wall, size_t failed)
+{
+	std::sort(seconds.begin(), seconds.end());
+	std::printf("%-12s %6zu calls %5zu failed  p50 %8.2f ms  p95 %8.2f ms  p99 %8.2f ms  max %8.2f ms  %8.1f calls/s\n", label, seconds.size(), failed,
+				percentile(seconds, 0.50) * 1000.0, percentile(seconds, 0.95) * 1000.0, percentile(seconds, 0.99) * 1000.0, seconds.empty() ? 0.0 : seconds.back() * 1000.0,
+				wall > 0.0 ? static_cast<double>(seconds.size()) / wall : 0.0);
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+
+// Back-to-back watchlist polls, each one sharded and fanned out by fetch_watchlist_prices.
+void run_price_polls(const LoadOptions& options, const std::vector<std::string>& watchlist, RequestEngine& engine)
+{
+	std::vector<double> latencies;
+	size_t failed	   = 0;
+	size_t quotes	   = 0;
+	FetchReport totals = {};
+	const auto start   = std::chrono::steady_clock::now();
+	for (size_t idx_for_i = 0; idx_for_i < options.polls; ++idx_for_i)
+	{
+		PriceSnapshot snapshot;
+		FetchReport report;
+		const auto poll_start = std::chrono::steady_clock::now();
+		if (!fetch_watchlist_prices(watchlist, "load-test", snapshot, &report, engine))
+		{
+			++failed;
+		}
+		latencies.push_back(seconds_since(poll_start));
+		quotes += snapshot.quotes.size();
+		totals.requests += report.requests;
+		totals.failed += report.failed;
+		totals.throttled += report.throttled;
+	}
+	print_latencies("simple/price", latencies, seconds_since(start), failed);
+	std::printf("             %zu requests, %zu failed, %zu throttled, %zu quotes\n", totals.requests, totals.failed, totals.throttled, quotes);
+}
+
+// market_chart downloads from `concurrency` threads at once, like a watchlist's worth of history loads.
+void run_history_fetches(const LoadOptions& options, const std::vector<std::string>& watchlist, RequestEngine& engine)
+{
+	std::vector<std::vector<double>> latencies(options.concurrency);
+	std::atomic<size_t> next{0};
+	std::atomic<size_t> failed{0};
+	std::atomic<size_t> points{0};
+	std::vector<std::thread> workers;
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t worker = 0; worker < options.concurrency; ++worker)
+	{
+		workers.emplace_back(
+			[&, worker]
+			{
+				std::vector<double> times;
+				std::vector<double> prices;
+				for (size_t index = next++; index < options.history; index = next++)
+				{
+					times.clear();
+					prices.clear();
+					const auto fetch_start = std::chrono::steady_clock::now();
+					if (!fetch_crypto_history(watchlist[index % watchlist.size()], options.days, times, prices, engine))
+					{
+						++failed;
+					}
+					latencies[worker].push_back(seconds_since(fetch_start));
+					points += prices.size();
+				}
+			});
+	}
+	for (auto& thread : workers)
+	{
+		thread.join();
+	}
+
+	std::vector<double> merged;
+	for (const auto& worker_latencies : latencies)
+	{
+		merged.insert(merged.end(), worker_latencies.begin(), worker_latencies.end());
+	}
+	print_latencies("market_chart", merged, seconds_since(start), failed);
+	std::printf("             %zu points\n", points.load());
+}
+
+// Tokenizer time alone, from the parse zone both fetch paths record into.
+void print_parse_profile()
+{
+	std::vector<float> scratch;
+	const ProfileStats stats = g_profiler.stats(ProfileZone::parse, scratch);
+	std::printf("%-12s %6llu calls  p50 %8.2f ms  p99 %8.2f ms  max %8.2f ms\n", "json parse", static_cast<unsigned long long>(stats.count), stats.p50_ms, stats.p99_ms, stats.max_ms);
+}
+
+void print_usage(const char* program)
+{
+	std::cerr << "usage: " << program << " [--url <base>] [--assets <n>] [--polls <n>] [--history <n>] [--days <n>] [--concurrency <n>]\n"
+			  << "       mock options when no --url is given: [--latency <ms>] [--jitter <ms>] [--errors <rate>] [--throttle <rate>] [--retry-after <s>] [--seed <n>] [--replay <dir>]\n";
+}
+
+// Drives the real client code against the bundled mock (started in-process unless --url names another server) and
+// prints latency percentiles and throughput. With a fixed --seed and no --url the injected failures are reproducible.
+int main(int argc, char** argv)
+{
+	LoadOptions options;
+	MockConfig mock;
+	mock.port = 0;
+	for (int idx_for_i = 1; idx_for_i < argc; ++idx_for_i)
+	{
+		const std::string arg = argv[idx_for_i];
+		if (idx_for_i + 1 >= argc)
+		{
+			print_usage(argv[0]);
+			return -1;
+		}
+		const char* value = argv[++idx_for_i];
+		if (arg == "--url")
+		{
+			options.url = value;
+		}
+		else if (arg == "--assets")
+		{
+			options.assets = std::strtoul(value, nullptr, 10);
+		}
+		else if (arg == "--polls")
+		{
+			options.polls = std::strtoul(value, nullptr, 10);
+		}
+		else if (arg == "--history")
+		{
+			options.history = std::strtoul(value, nullptr, 10);
+		}
+		else if (arg == "--days")
+		{
+			options.days = std::atoi(value);
+		}
+		else if (arg == "--concurrency")
+		{
+			options.concurrency = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+		}
+		else if (arg == "--latency")
+		{
+			mock.latency_ms = std::atoi(value);
+		}
+		else if (arg == "--jitter")
+		{
+			mock.jitter_ms = std::atoi(value);
+		}
+		else if (arg == "--errors")
+		{
+			mock.error_rate = std::strtod(value, nullptr);
+		}
+		else if (arg == "--throttle")
+		{
+			mock.throttle_rate = std::strtod(value, nullptr);
+		}
+		else if (arg == "--retry-after")
+		{
+			mock.retry_after = std::atoi(value);
+		}
+		else if (arg == "--seed")
+		{
+			mock.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+		}
+		else if (arg == "--replay")
+		{
+			mock.replay_dir = value;
+		}
+		else
+		{
+			print_usage(argv[0]);
+			return -1;
+		}
+	}
+
+	MockCoinGecko server;
+	if (options.url.empty())
+	{
+		if (!server.start(mock))
+		{
+			return -1;
+		}
+		options.url = server.base_url();
+	}
+	g_coingecko_base_url = options.url;
+
+	std::vector<std::string> watchlist;
+	for (size_t idx_for_i = 0; idx_for_i < std::max<size_t>(1, options.assets); ++idx_for_i)
+	{
+		watchlist.push_back("asset-" + std::to_string(idx_for_i));
+	}
+
+	std::printf("target %s, %zu assets (%zu shards), concurrency %zu\n", options.url.c_str(), watchlist.size(), shard_watchlist(watchlist).size(), options.concurrency);
+
+	curl_global_init(CURL_GLOBAL_DEFAULT);
+	{
+		RequestEngine engine(options.concurrency);
+		engine.start();
+		run_price_polls(options, watchlist, engine);
+		run_history_fetches(options, watchlist, engine);
+		print_parse_profile();
+		engine.stop();
+	}
+	g_curl_pool.shutdown();
+	curl_global_cleanup();
+
+	server.stop();
+	if (server.port() != 0)
+	{
+		const MockStats& stats = server.stats();
+		std::printf("mock served %llu requests, %llu errors, %llu throttled\n", static_cast<unsigned long long>(stats.requests.load()),
+					static_cast<unsigned long long>(stats.errors.load()), static_cast<unsigned long long>(stats.throttled.load()));
+	}
+	return 0;
+}
@@ -1,7 +1,29 @@
 #include "../include/main.hpp"
 
-int main(int, char**)
+int main(int argc, char** argv)
 {
+	bool profile_dump = false;
+	for (int idx_for_i = 1; idx_for_i < argc; ++idx_for_i)
+	{
+		if (std::string(argv[idx_for_i]) == "--continuous")
+		{
+			g_on_demand_render = false;
+		}
+		else if (std::string(argv[idx_for_i]) == "--bus")
+		{
+			g_bus_mode = true;
+		}
+		else if (std::string(argv[idx_for_i]) == "--profile")
+		{
+			g_show_profiler = true;
+		}
+		else if (std::string(argv[idx_for_i]) == "--profile-dump" && idx_for_i + 1 < argc)
+		{
+			g_profile_dump_path = argv[++idx_for_i];
+			profile_dump		= true;
+		}
+	}
+
 	curl_global_init(CURL_GLOBAL_DEFAULT);
 
 	g_api_key = read_api_key();
@@ -11,6 +33,16 @@ int main(int, char**)
 		return -1;
 	}
 	load_watchlist("config/watchlist.txt");
+	g_watchlist_persister.start("config/watchlist.txt");
+	rebuild_asset_rows();
+	// The daemon owns the journal in bus mode, and may be sealing blocks while the viewer replays it; a missing bus is
+	// retried on every poll.
+	const bool journal_owned = !g_bus_mode && g_tick_journal.start("data/ticks");
+	replay_tick_journal("data/ticks", g_assets, g_price_history, journal_owned);
+	if (g_bus_mode)
+	{
+		g_market_bus.open();
+	}
 
 	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER) != 0)
 	{
@@ -46,41 +78,93 @@ int main(int, char**)
 
 	ImGui::StyleColorsDark();
 
-	g_last_fetch = std::chrono::steady_clock::now() - std::chrono::seconds(10);
+	g_wake_event = SDL_RegisterEvents(1);
+	g_ingest.set_on_publish(request_redraw);
+	g_history.set_on_ready(request_redraw);
+	if (!g_bus_mode)
+	{
+		// History downloads wait for the ingest thread's poll budget instead of all going out at once.
+		g_history.set_on_queued([] { g_ingest.wake(); });
+		g_ingest.set_history([] { return g_history.queued(); }, [] { return g_history.submit_next(); });
+	}
+	if (g_bus_mode)
+	{
+		g_market_bus_watcher.start(bus_default_name, request_redraw);
+	}
+
+	g_request_engine.start();
+	if (!g_bus_mode)
+	{
+		g_ingest.set_watchlist(g_crypto_watchlist);
+		g_ingest.start(g_api_key);
+	}
+	if (!g_bus_mode)
+	{
+		g_history.prefetch(g_crypto_watchlist, 7);
+	}
+
+	FrameAllocationCheck alloc_check;
+
+	// ImGui needs a few frames after an input event to settle hover and active states.
+	const int settle_frames = 3;
+	int redraw_frames		= settle_frames;
 
 	bool running = true;
 	while (running)
 	{
+		alloc_check.begin_frame();
+		bool steady_state = true;
+
 		SDL_Event event;
-		while (SDL_PollEvent(&event))
+		bool idle		= g_on_demand_render && redraw_frames == 0 && !io.WantTextInput;
+		bool has_event	= idle ? SDL_WaitEventTimeout(&event, 1000) != 0 : SDL_PollEvent(&event) != 0;
+		while (has_event)
 		{
-			ImGui_ImplSDL2_ProcessEvent(&event);
+			steady_state  = false;
+			redraw_frames = settle_frames;
+			if (event.type == g_wake_event)
+			{
+				g_wake_pending = false;
+			}
+			else
+			{
+				ImGui_ImplSDL2_ProcessEvent(&event);
+			}
 			if (event.type == SDL_QUIT)
 			{
 				running = false;
 			}
+			if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F3)
+			{
+				g_show_profiler = !g_show_profiler;
+			}
+			has_event = SDL_PollEvent(&event) != 0;
 		}
 
-		auto now = std::chrono::steady_clock::now();
-		if (std::chrono::duration_cast<std::chrono::seconds>(now - g_last_fetch).count() >= 5)
+		PriceSnapshot snapshot;
+		while (g_ingest.poll(snapshot))
 		{
-			fetch_watchlist_prices();
-			g_last_fetch = now;
-
-			double now_sec = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
-
-			for (const auto& [id, price] : g_prices)
-			{
-				auto& history = g_price_history_map[id];
-				history.push_back({now_sec, price});
+			steady_state  = false;
+			redraw_frames = settle_frames;
+			apply_price_snapshot(snapshot);
+		}
+		if (g_bus_mode && g_market_bus.poll(snapshot))
+		{
+			steady_state  = false;
+			redraw_frames = settle_frames;
+			apply_price_snapshot(snapshot);
+		}
 
-				if (history.size() > 12096)
-				{
-					history.pop_front();
-				}
-			}
+		if (g_on_demand_render && redraw_frames == 0 && !io.WantTextInput)
+		{
+			continue;
+		}
+		if (redraw_frames > 0)
+		{
+			--redraw_frames;
 		}
 
+		ProfileScope frame_scope(ProfileZone::frame);
 		ImGui_ImplOpenGL3_NewFrame();
 		ImGui_ImplSDL2_NewFrame();
 		ImGui::NewFrame();
@@ -101,10 +185,15 @@ int main(int, char**)
 		{
 			std::string crypto = g_input_crypto;
 			std::transform(crypto.begin(), crypto.end(), crypto.begin(), ::tolower);
-			if (!crypto.empty() && std::find(g_crypto_watchlist.begin(), g_crypto_watchlist.end(), crypto) == g_crypto_watchlist.end())
+			if (!crypto.empty() && !g_assets.watched(g_assets.intern(crypto)))
 			{
 				g_crypto_watchlist.push_back(crypto);
 				g_input_crypto[0] = '\0';
+				on_watchlist_changed();
+				if (!g_bus_mode)
+				{
+					g_history.request(crypto, 7, false);
+				}
 			}
 		}
 
@@ -112,48 +201,55 @@ int main(int, char**)
 		ImGui::Separator();
 		ImGui::Text("observing crypto: ");
 
-		for (auto it = g_crypto_watchlist.begin(); it != g_crypto_watchlist.end();)
+		auto board			= g_market_board.read();
+		size_t remove_index = g_asset_rows.size();
+		for (size_t idx_for_i = 0; idx_for_i < g_asset_rows.size(); ++idx_for_i)
 		{
-			const std::string& id = *it;
-			float price			  = g_prices.count(id) ? g_prices[id] : 0.0F;
+			const AssetRow& row = g_asset_rows[idx_for_i];
 
-			ImGui::BulletText("%s: $%.2F", id.c_str(), price);
+			ImGui::BulletText("%s: $%.2F", row.id.c_str(), board ? board->price(row.asset) : 0.0F);
 
 			ImGui::SameLine();
-			std::string btn_focus = "Focus##" + id;
-			if (ImGui::Button(btn_focus.c_str()))
+			if (ImGui::Button(row.focus_label.c_str()))
 			{
-				g_focused_crypto = id;
+				set_focused_asset(row.asset);
 			}
 
 			ImGui::SameLine();
-			std::string btn_id = "Remove##" + id;
-			if (ImGui::Button(btn_id.c_str()))
+			if (ImGui::Button(row.remove_label.c_str()))
 			{
-				it = g_crypto_watchlist.erase(it);
-				continue;
+				remove_index = idx_for_i;
 			}
-			++it;
 		}
 
-		ImGui::End();
-
-		if (!g_focused_crypto.empty() && g_price_history_map.count(g_focused_crypto))
+		if (remove_index < g_asset_rows.size())
 		{
-			const auto& history = g_price_history_map[g_focused_crypto];
+			g_indicators.erase(g_asset_rows[remove_index].asset);
+			g_crypto_watchlist.erase(g_crypto_watchlist.begin() + static_cast<std::ptrdiff_t>(remove_index));
+			on_watchlist_changed();
+		}
 
-			std::vector<double> x_axis;
-			std::vector<double> y_axis;
-			for (const auto& pt : history)
-			{
-				x_axis.push_back(pt.timestamp);
-				y_axis.push_back(pt.price);
-			}
+		ImGui::End();
 
+		const TimeSeries* history = g_focused_asset == no_asset ? nullptr : g_price_history.find(g_focused_asset);
+		if (history)
+		{
+			const std::string& focused_id = g_assets.name(g_focused_asset);
 			if (ImPlot::BeginPlot("Price History", ImVec2(-1, 300)))
 			{
 				ImPlot::SetupAxes("Time", "USD");
-				ImPlot::PlotLine(g_focused_crypto.c_str(), x_axis.data(), y_axis.data(), x_axis.size());
+				static LodView history_view;
+				static LodView archive_lod_view;
+				static ArchiveView archive_view;
+				refresh_archive_view(g_focused_asset, *history, archive_view);
+				if (!archive_view.times.empty())
+				{
+					plot_lod_line(focused_id.c_str(), VectorSeriesView{archive_view.times, archive_view.prices}, archive_view.lod, archive_lod_view);
+				}
+				if (const LodPyramid* lod = g_price_history.find_lod(g_focused_asset))
+				{
+					plot_lod_line(focused_id.c_str(), *history, *lod, history_view);
+				}
 				ImPlot::EndPlot();
 			}
 
@@ -162,57 +258,118 @@ int main(int, char**)
 			ImGui::Begin("Crypto Details", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse);
 
 			ImGui::SetCursorPos(ImVec2(0, 0));
-			ImGui::Text("Details for: %s", g_focused_crypto.c_str());
+			ImGui::Text("Details for: %s", focused_id.c_str());
 
-			static std::string last_crypto;
-			static std::vector<double> hist_times, hist_prices;
-			static bool hist_loaded = false;
-			if (last_crypto != g_focused_crypto)
+			static AssetId last_asset = no_asset;
+			static HistoryHandle hist_handle;
+			if (last_asset != g_focused_asset)
 			{
-				hist_times.clear();
-				hist_prices.clear();
-				hist_loaded = fetch_crypto_history(g_focused_crypto, hist_times, hist_prices);
-				last_crypto = g_focused_crypto;
+				hist_handle = request_history(focused_id, 7);
+				last_asset	= g_focused_asset;
 			}
 
-			if (hist_loaded && hist_times.size() > 1)
+			const HistorySeries* hist = history_ready(hist_handle) ? hist_handle.get().get() : nullptr;
+			if (hist && hist->ok && hist->times.size() > 1)
 			{
 
 				if (ImPlot::BeginPlot("Last 7 days", ImVec2(-1, 300)))
 				{
 					ImPlot::SetupAxes("Date", "USD", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
 					ImPlot::SetupAxisFormat(ImAxis_X1, format_timestamp);
-					ImPlot::PlotLine("USD", hist_times.data(), hist_prices.data(), hist_prices.size());
+					static LodView hist_view;
+					plot_lod_line("USD", VectorSeriesView{hist->times, hist->prices}, hist->lod, hist_view);
 					ImPlot::EndPlot();
 				}
 
-				analyze_crypto(hist_times, hist_prices);
+				if (!g_indicators.contains(g_focused_asset))
+				{
+					ProfileScope seed_scope(ProfileZone::seed);
+					g_indicators.seed_closed(g_focused_asset, hist->candles.interval(indicator_interval));
+				}
+				if (const IndicatorSeries* indicators = g_indicators.find(g_focused_asset))
+				{
+					analyze_crypto(*indicators);
+				}
+			}
+			else if (hist)
+			{
+				ImGui::Text("History unavailable");
+				ImGui::SameLine();
+				if (ImGui::Button("Retry"))
+				{
+					hist_handle = request_history(focused_id, 7);
+				}
 			}
 			else
 			{
 				ImGui::Text("Loading history...");
 			}
 
-			float focused_price = g_prices.count(g_focused_crypto) ? g_prices[g_focused_crypto] : 0.0F;
-			ImGui::Text("Actual Price: $%.2F", focused_price);
+			static int candle_interval = 2;
+			ImGui::Combo("Candles", &candle_interval, candle_interval_labels.data(), static_cast<int>(candle_interval_count));
+
+			const CandleSet* live_candles	 = g_price_history.find_candles(g_focused_asset);
+			const CandleSet* history_candles = hist && hist->ok ? &hist->candles : nullptr;
+			if ((live_candles || history_candles) && ImPlot::BeginPlot("OHLC", ImVec2(-1, 300)))
+			{
+				ImPlot::SetupAxes("Date", "USD", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+				ImPlot::SetupAxisFormat(ImAxis_X1, format_timestamp);
+
+				const size_t interval = static_cast<size_t>(candle_interval);
+				double live_start	  = std::numeric_limits<double>::infinity();
+				if (live_candles && !live_candles->interval(interval).empty())
+				{
+					live_start = live_candles->interval(interval)[0].time;
+				}
+				if (history_candles)
+				{
+					plot_candles(focused_id.c_str(), history_candles->interval(interval), live_start);
+				}
+				if (live_candles)
+				{
+					plot_candles(focused_id.c_str(), live_candles->interval(interval), std::numeric_limits<double>::infinity());
+				}
+				ImPlot::EndPlot();
+			}
+
+			ImGui::Text("Actual Price: $%.2F", board ? board->price(g_focused_asset) : 0.0F);
 
 			ImGui::Spacing();
 			if (ImGui::Button("Close"))
 			{
-				g_focused_crypto.clear();
+				set_focused_asset(no_asset);
 			}
 
 			ImGui::End();
 		}
 
-		ImGui::Render();
-		save_watchlist("config/watchlist.txt");
-		glViewport(0, 0, (int)io.DisplaySize.x, (int)io.DisplaySize.y);
-		glClearColor(0.1F, 0.1F, 0.1F, 1.0F);
-		glClear(GL_COLOR_BUFFER_BIT);
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		if (g_show_profiler)
+		{
+			draw_profiler_overlay(io);
+		}
+
+		{
+			// Includes the swap, so with vsync on this also shows time spent waiting for the display.
+			ProfileScope render_scope(ProfileZone::render);
+			ImGui::Render();
+			glViewport(0, 0, (int)io.DisplaySize.x, (int)io.DisplaySize.y);
+			glClearColor(0.1F, 0.1F, 0.1F, 1.0F);
+			glClear(GL_COLOR_BUFFER_BIT);
+			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+			SDL_GL_SwapWindow(window);
+		}
+		alloc_check.end_frame(steady_state);
+	}
 
-		SDL_GL_SwapWindow(window);
+	g_ingest.stop();
+	g_market_bus_watcher.stop();
+	g_request_engine.stop();
+	g_watchlist_persister.stop();
+	g_tick_journal.stop();
+	if (profile_dump)
+	{
+		g_profiler.dump(g_profile_dump_path, g_tick_clock.now());
 	}
 
 	std::system("gpgconf --kill gpg-agent");
@@ -226,6 +383,7 @@ int main(int, char**)
 	SDL_DestroyWindow(window);
 	SDL_Quit();
 
+	g_curl_pool.shutdown();
 	curl_global_cleanup();
 
 	return 0;
@@ -0,0 +1,89 @@
+#include "../include/mock_coingecko.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+volatile std::sig_atomic_t g_mock_stop = 0;
+
+void on_mock_signal(int) { g_mock_stop = 1; }
+
+void print_usage(const char* program)
+{
+	std::cerr << "usage: " << program
+			  << " [--port <n>] [--latency <ms>] [--jitter <ms>] [--errors <rate>] [--throttle <rate>] [--retry-after <seconds>] [--seed <n>] [--replay <dir>]\n";
+}
+
+int main(int argc, char** argv)
+{
+	MockConfig config;
+	for (int idx_for_i = 1; idx_for_i < argc; ++idx_for_i)
+	{
+		const std::string arg = argv[idx_for_i];
+		if (idx_for_i + 1 >= argc)
+		{
+			print_usage(argv[0]);
+			return -1;
+		}
+		const char* value = argv[++idx_for_i];
+		if (arg == "--port")
+		{
+			config.port = static_cast<uint16_t>(std::strtoul(value, nullptr, 10));
+		}
+		else if (arg == "--latency")
+		{
+			config.latency_ms = std::atoi(value);
+		}
+		else if (arg == "--jitter")
+		{
+			config.jitter_ms = std::atoi(value);
+		}
+		else if (arg == "--errors")
+		{
+			config.error_rate = std::strtod(value, nullptr);
+		}
+		else if (arg == "--throttle")
+		{
+			config.throttle_rate = std::strtod(value, nullptr);
+		}
+		else if (arg == "--retry-after")
+		{
+			config.retry_after = std::atoi(value);
+		}
+		else if (arg == "--seed")
+		{
+			config.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+		}
+		else if (arg == "--replay")
+		{
+			config.replay_dir = value;
+		}
+		else
+		{
+			print_usage(argv[0]);
+			return -1;
+		}
+	}
+
+	MockCoinGecko server;
+	if (!server.start(config))
+	{
+		return -1;
+	}
+	std::cout << "mock CoinGecko listening, point clients at COINGECKO_BASE_URL=" << server.base_url() << "\n";
+
+	std::signal(SIGINT, on_mock_signal);
+	std::signal(SIGTERM, on_mock_signal);
+	while (!g_mock_stop)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	}
+
+	server.stop();
+	const MockStats& stats = server.stats();
+	std::cout << "requests: " << stats.requests << ", errors: " << stats.errors << ", throttled: " << stats.throttled << ", not found: " << stats.not_found << "\n";
+	return 0;
+}
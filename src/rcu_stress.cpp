@@ -0,0 +1,124 @@
+#include "../include/market_board.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct StressOptions
+{
+	size_t readers	 = 6;
+	size_t publishes = 200000;
+	size_t assets	 = 300;
+	size_t touched	 = 8;
+};
+
+// Every quote the writer sets has price == time == the board sequence that wrote it, so a reader can tell a torn or
+// recycled board from a good one: no entry may be newer than its board, and price and time must agree.
+bool check_board(const MarketBoard& board, uint64_t& last_sequence)
+{
+	if (board.sequence < last_sequence)
+	{
+		return false;
+	}
+	last_sequence = board.sequence;
+	for (AssetId asset = 0; asset < board.size(); ++asset)
+	{
+		const double time = board.time(asset);
+		if (time > static_cast<double>(board.sequence) || static_cast<double>(board.price(asset)) != time)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Hammers RcuCell<MarketBoard> from concurrent readers while one writer publishes copy-on-write boards. Build with
+// -DTRADE_MARKET_SANITIZER=thread or =address to run it under TSan or ASan.
+int main(int argc, char** argv)
+{
+	StressOptions options;
+	for (int idx_for_i = 1; idx_for_i + 1 < argc; idx_for_i += 2)
+	{
+		const std::string arg = argv[idx_for_i];
+		const size_t value	  = std::strtoul(argv[idx_for_i + 1], nullptr, 10);
+		if (arg == "--readers")
+		{
+			options.readers = value;
+		}
+		else if (arg == "--publishes")
+		{
+			options.publishes = value;
+		}
+		else if (arg == "--assets")
+		{
+			options.assets = value;
+		}
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--readers <n>] [--publishes <n>] [--assets <n>]\n", argv[0]);
+			return -1;
+		}
+	}
+
+	AssetRegistry assets;
+	for (size_t idx_for_i = 0; idx_for_i < options.assets; ++idx_for_i)
+	{
+		assets.intern("asset-" + std::to_string(idx_for_i));
+	}
+
+	MarketBoardCell cell;
+	std::atomic<bool> done{false};
+	std::atomic<size_t> failures{0};
+	std::atomic<uint64_t> reads{0};
+	std::vector<std::thread> readers;
+	for (size_t reader = 0; reader < options.readers; ++reader)
+	{
+		readers.emplace_back(
+			[&, reader]
+			{
+				uint64_t last_sequence = 0;
+				uint64_t local_reads   = 0;
+				while (!done.load(std::memory_order_relaxed))
+				{
+					auto board = cell.read();
+					if (board && !check_board(*board, last_sequence))
+					{
+						++failures;
+					}
+					// Some readers hold their guard across several publishes, so retired boards must outlive them.
+					if (reader % 2 == 1)
+					{
+						std::this_thread::yield();
+					}
+					++local_reads;
+				}
+				reads += local_reads;
+			});
+	}
+
+	MarketBoardWriter writer(cell);
+	std::mt19937 random(42);
+	std::uniform_int_distribution<AssetId> pick(0, static_cast<AssetId>(options.assets - 1));
+	for (size_t publish = 1; publish <= options.publishes; ++publish)
+	{
+		writer.begin(static_cast<double>(publish));
+		for (size_t idx_for_i = 0; idx_for_i < options.touched; ++idx_for_i)
+		{
+			writer.set(pick(random), static_cast<float>(publish), static_cast<double>(publish));
+		}
+		writer.publish(assets);
+	}
+
+	done = true;
+	for (auto& thread : readers)
+	{
+		thread.join();
+	}
+
+	std::printf("%zu publishes, %llu reads, %zu bad boards\n", options.publishes, static_cast<unsigned long long>(reads.load()), failures.load());
+	return failures.load() == 0 ? 0 : 1;
+}